@@ -103,6 +103,18 @@ void comint_comint(Uint16 command,Uint16 dataWord,bool dataPresent){
     	}
         break;
 
+#ifdef TASKMGR_ENABLE_PROFILE
+    case 0x1021: // Report execution time profile for task # dddd on RS232
+    	if (dataPresent){
+    		taskMgr_displayProfile(dataWord);
+    	}
+        break;
+
+    case 0x1022: // Reset execution time profile for all tasks
+    	taskMgr_profileReset();
+        break;
+#endif
+
     case 0x1030: // Read GPIOA bits 2 & 0, and report to RS232
     	// Note: TB3CMA Protos were blue-wired connecting
     	//  GPIOA0 == PG_1V2_I/O, and
@@ -233,6 +233,20 @@ void f2i_BgTask_SSEnc(void){
 //    U T I L I T I E S
 // ==========================================================================
 
+// CRC_5 for EnDat, polynomial x^5 + x^3 + x + 1 (0x0B), processed a nibble at a time.
+// Entry i is the CRC register after shifting 4 zero data bits through a register
+// whose 4 MS bits are i, so one lookup does the work of 4 passes of the bitwise loop.
+const Uint16 f2i_crc5NibbleTable[16] = {
+	0x00, 0x0B, 0x16, 0x1D, 0x07, 0x0C, 0x11, 0x1A,
+	0x0E, 0x05, 0x18, 0x13, 0x09, 0x02, 0x1F, 0x14
+};
+
+// Bit-reverse of each 4-bit value, used to bit-reverse position data a nibble at a time
+const Uint16 f2i_reverseNibbleTable[16] = {
+	0x0, 0x8, 0x4, 0xC, 0x2, 0xA, 0x6, 0xE,
+	0x1, 0x9, 0x5, 0xD, 0x3, 0xB, 0x7, 0xF
+};
+
 Uint16 f2i_CRC5(Uint16 data_1, Uint16 data_2,Uint16 num_bits) {
 // 5-bit CRC for EnDat communications.
 // Data bit-stream to run CRC on is max 32 bits, in data_1 and data_2,
@@ -246,32 +260,40 @@ Uint16 f2i_CRC5(Uint16 data_1, Uint16 data_2,Uint16 num_bits) {
 //   ( left shift position 1 bit, and insert alarm_bit 0, on right ==> 0x0000246)
 //   ( now bit reverse that value because alarm bit is first bit to xmit, followed by LS bit of position)
 //   ( ==> 0x62400000 ==> data_1 = 0x6240, data_2 = 0x0000, num_bits = 14 (== 13-position + 1-alarm))
+//
+// Whole nibbles go through f2i_crc5NibbleTable[], then the last 0 - 3 bits one at a
+// time, so a 32-bit CRC always takes 8 table lookups.
 
 	Uint16 EnDat_CRC_Reg;
+	Uint16 data;
+	Uint16 nibbles;
+	Uint16 bits;
 	Uint16 i;
-	Uint16 j;
-	Uint16 data_byte[5];
-	Uint16 count;
 
 	EnDat_CRC_Reg = 0x1F;
-	count = num_bits;
-
-	//Lets peel the data off, into bytes
-	data_byte[0] = (data_1 >> 8) & 0x00FF;
-	data_byte[1] = data_1 & 0x00FF;
-	data_byte[2] = (data_2 >> 8) & 0x00FF;
-	data_byte[3] = data_2 & 0x00FF;
-	data_byte[4] = 0;
-
-	for (j=0;j<5;j++){
-		for (i=0;(i<8)&(count>0);i++){
-			count--;
-			EnDat_CRC_Reg = (EnDat_CRC_Reg << 1) & 0x3E;
-			if (((EnDat_CRC_Reg >> 5) ^ (data_byte[j] >> 7))& 0x0001) {
-				EnDat_CRC_Reg = EnDat_CRC_Reg ^ 0x000B;
-			}
-			data_byte[j] = (data_byte[j] << 1) & 0x00FE;
+	if (num_bits > 40) {
+		num_bits = 40;   // as before: 32 data bits, then at most 8 more 0 bits
+	}
+	nibbles = num_bits >> 2;
+	bits = num_bits & 0x0003;
+
+	data = data_1;
+	for (i=0;i<nibbles;i++){
+		EnDat_CRC_Reg = ((EnDat_CRC_Reg << 4) & 0x001F)
+				      ^ f2i_crc5NibbleTable[((EnDat_CRC_Reg >> 1) ^ (data >> 12)) & 0x000F];
+		if (i == 3) {
+			data = data_2;   // done with the 4 nibbles in data_1
+		} else {
+			data = data << 4;
+		}
+	}
+	while (bits > 0) {
+		bits--;
+		EnDat_CRC_Reg = (EnDat_CRC_Reg << 1) & 0x3E;
+		if (((EnDat_CRC_Reg >> 5) ^ (data >> 15))& 0x0001) {
+			EnDat_CRC_Reg = EnDat_CRC_Reg ^ 0x000B;
 		}
+		data = data << 1;
 	}
 	return ((EnDat_CRC_Reg & 0x001F) ^ 0x001F);
 }
@@ -284,22 +306,28 @@ void f2i_SSEnc_reverse_position(void){
 // which should be from 1 to 31.
 // Result is left in 2 16-bit variables, f2i_SSEnc_Pos_1 & 2, ready to hand off
 // to FPGA2 SSEnc code.
+//
+// Bit-reversing all 32 bits of position puts the LS bit at 0x80000000, then we keep the
+// f2i_SSEnc_Num_Pos_Bits MS bits and shift them right 1 to make room for the alarm bit.
 
 	Uint16 i;
+	Uint16 numBits;
 	Uint32 reversedPos;
 	Uint32 Pos_32;
 
-	reversedPos = f2i_SSEnc_Alarm_Bit & 0x0001;
-
-	Pos_32 = f2i_SSEnc_Pos_32;
-	for (i=f2i_SSEnc_Num_Pos_Bits;i>0;i--){
-		reversedPos = (reversedPos << 1) & 0xFFFFFFFE;
-		reversedPos = reversedPos | (Pos_32 & 0x00000001);
-		Pos_32 = Pos_32 >> 1;
+	numBits = f2i_SSEnc_Num_Pos_Bits;
+	if (numBits > 31) {
+		numBits = 31;
 	}
-	for (i=(31 - f2i_SSEnc_Num_Pos_Bits);i>0;i--){
-	reversedPos = (reversedPos << 1) & 0xFFFFFFFE;
+	Pos_32 = f2i_SSEnc_Pos_32;
+	reversedPos = 0;
+	for (i=8;i>0;i--){
+		reversedPos = (reversedPos << 4) | f2i_reverseNibbleTable[(Uint16)Pos_32 & 0x000F];
+		Pos_32 = Pos_32 >> 4;
 	}
+	reversedPos = (reversedPos & ~(0xFFFFFFFF >> numBits)) >> 1;
+	reversedPos |= ((Uint32)(f2i_SSEnc_Alarm_Bit & 0x0001)) << 31;
+
 	// put results back in persistant static locations
 	f2i_SSEnc_Pos_1 = (Uint16)(reversedPos >> 16);
 	f2i_SSEnc_Pos_2 = (Uint16)(reversedPos & 0x0000FFFF);
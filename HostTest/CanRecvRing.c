@@ -0,0 +1,215 @@
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+//
+//     CanRecvRing.c
+//
+// Host stress test of the eCAN receive path: canC_recvIsr() copying frames
+// out of the receive mailboxes into canRxRing[], canC_BgTask_recv() taking
+// them out, run by the real task manager.  Frames arrive through ECanSim.c,
+// each carrying a sequence number, and are checked as CanOpen gets them:
+// intact, each at most once, in order per mailbox.  Every frame sent must
+// be delivered or accounted for: overwritten in its mailbox by the next
+// frame (canC_rxMsgLostCount counts the times CANRML flagged that), or
+// dropped and counted in canC_rxRingOverrunCount because the ring was full.
+//  1. ring wrap: frames one at a time, the background draining after a
+//     random lag, some lags long enough to fill the ring
+//  2. interrupts held off while frames pile up in the mailboxes, some
+//     overwriting unread ones
+//  3. frames arriving from an interrupt between any two instructions of
+//     the background task (SingleStep.c)
+//
+//     CanRecvRing [frames]
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "DSP281x_Device.h"
+#include "CanOpen.H"
+#include "CanComm.H"
+#include "TaskMgr.h"
+#include "ECanSim.h"
+#include "SingleStep.h"
+
+#define RING_SLOTS 15		// CAN_RX_RING_SIZE - 1 frames fit
+
+static int fails;
+#define CHECK(c, ...) do { if (!(c)) { printf("FAIL %s:%d ", __FILE__, __LINE__); \
+	printf(__VA_ARGS__); printf("\n"); fails++; } } while (0)
+
+static Uint32 sent, delivered, overwritten;
+static Uint32 lostFlagged;		// overwrites that set CANRML, which says only "one or more"
+static Uint32 lastSeq[32];		// per mailbox, last sequence number delivered + 1
+static Uint16 lastMbx;
+static unsigned char* seen;
+static Uint32 maxFrames;
+
+static Uint32 frameCheck(Uint32 seq){
+	return (seq * 2654435761u) ^ 0xA5A5C3C3u;
+}
+
+// a frame from the bus, into receive mailbox 16 - 31
+static void sendFrame(Uint16 mbx){
+	if (ECanaRegs.CANRMP.all & (1L << mbx)) {
+		overwritten++;
+		if ((ECanaRegs.CANRML.all & (1L << mbx)) == 0) {
+			lostFlagged++;
+		}
+	}
+	ecanSim_receive(mbx, sent, frameCheck(sent));
+	sent++;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// what canC_BgTask_recv() hands each frame to
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void diagRs232CanRecvMsg(Uint16 mbxNumber, Uint16* msg){
+	(void)msg;
+	lastMbx = mbxNumber;
+}
+
+enum CANOPEN_STATUS canO_HandleCanOpenMessage(Uint16* rcvMsg, Uint16* xmtMsg){
+	Uint32 seq = rcvMsg[0] | ((Uint32)rcvMsg[1] << 16);
+	Uint32 check = rcvMsg[2] | ((Uint32)rcvMsg[3] << 16);
+
+	(void)xmtMsg;
+	if (fails > 10) exit(1);
+	if ((seq >= sent) || (check != frameCheck(seq))) {
+		CHECK(0, "torn frame: seq %lu check %08lX", (unsigned long)seq, (unsigned long)check);
+		return CANOPEN_NO_ERR;
+	}
+	CHECK(!seen[seq], "frame %lu delivered twice", (unsigned long)seq);
+	CHECK((lastMbx >= 16) && (lastMbx < 32), "frame %lu from mailbox %u", (unsigned long)seq, lastMbx);
+	CHECK(seq >= lastSeq[lastMbx & 31], "mailbox %u: frame %lu after frame %lu", lastMbx, (unsigned long)seq, (unsigned long)lastSeq[lastMbx & 31] - 1);
+	seen[seq] = 1;
+	lastSeq[lastMbx & 31] = seq + 1;
+	delivered++;
+	return CANOPEN_NO_ERR;
+}
+
+static void drain(void){
+	int n;
+
+	for (n = 0; n < 1000; n++){
+		taskMgr_runBkgndTasks();
+	}
+}
+
+static void start(void){
+	ecanSim_reset();
+	taskMgr_init();
+	canC_recvRingInit();
+	canC_store_int_vectors_in_PIE();
+	canC_enable_interrupt();
+	sent = delivered = overwritten = lostFlagged = 0;
+	memset(lastSeq, 0, sizeof lastSeq);
+	memset(seen, 0, maxFrames);
+}
+
+static void checkCounts(const char* phase){
+	Uint32 dropped = sent - delivered - overwritten;
+
+	CHECK(ECanaRegs.CANRMP.all == 0, "%s: mailboxes %08lX not released", phase, (unsigned long)ECanaRegs.CANRMP.all);
+	CHECK(canC_rxFrameCount == delivered, "%s: canC_rxFrameCount %lu, %lu delivered", phase,
+		(unsigned long)canC_rxFrameCount, (unsigned long)delivered);
+	CHECK(canC_rxMsgLostCount == lostFlagged, "%s: canC_rxMsgLostCount %lu, %lu overwrites flagged in CANRML", phase,
+		(unsigned long)canC_rxMsgLostCount, (unsigned long)lostFlagged);
+	CHECK(canC_rxRingOverrunCount == dropped, "%s: canC_rxRingOverrunCount %lu, %lu dropped", phase,
+		(unsigned long)canC_rxRingOverrunCount, (unsigned long)dropped);
+	CHECK(canC_rxRingHighWater <= RING_SLOTS, "%s: high water %lu", phase, (unsigned long)canC_rxRingHighWater);
+	CHECK((dropped == 0) || (canC_rxRingHighWater == RING_SLOTS), "%s: dropped frames, high water only %lu", phase,
+		(unsigned long)canC_rxRingHighWater);
+	printf("%s: %lu frames, %lu delivered, %lu overwritten in a mailbox, %lu dropped with the ring full, high water %lu\n",
+		phase, (unsigned long)sent, (unsigned long)delivered, (unsigned long)overwritten, (unsigned long)dropped,
+		(unsigned long)canC_rxRingHighWater);
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// 1. ring wrap
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+static void ringWrap(Uint32 frames){
+	Uint32 lag = 0;
+
+	start();
+	while (sent < frames){
+		sendFrame(16 + (sent % 16));
+		if (lag-- == 0) {
+			drain();
+			lag = (rand() % 16 == 0) ? 16 + rand() % 8 : rand() % 8;
+		}
+	}
+	drain();
+	checkCounts("ring wrap");
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// 2. interrupts held off
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+static void heldOff(Uint32 frames){
+	int n, burst;
+
+	start();
+	while (sent < frames){
+		ecanSim_holdInterrupts = 1;
+		burst = 1 + rand() % 24;
+		for (n = 0; n < burst; n++){
+			sendFrame(16 + rand() % 16);
+		}
+		ecanSim_holdInterrupts = 0;
+		ecanSim_raiseInterrupts();
+		if (rand() % 2) drain();
+	}
+	drain();
+	checkCounts("held off");
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// 3. frames arriving anywhere in the background task
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+static void isrFrames(void){
+	int n, count = 1 + rand() % 3;
+
+	for (n = 0; n < count; n++){
+		sendFrame(16 + (sent % 16));
+	}
+}
+
+static void runOneTask(void){
+	taskMgr_runBkgndTasks();
+}
+
+static void interleaved(long runs){
+	long i, steps, longest = 1;
+	Uint32 waiting;
+
+	start();
+	for (i = 0; i < runs; i++){
+		// a few frames waiting, so the task has one to work on, or now and
+		// then the ring nearly or completely full
+		waiting = (rand() % 4 == 0) ? RING_SLOTS - rand() % 3 : 1 + rand() % 3;
+		if (canC_rxFrameCount - delivered > waiting) {
+			drain();
+		}
+		while (canC_rxFrameCount - delivered < waiting) {
+			sendFrame(16 + (sent % 16));
+		}
+		steps = singleStep_run(runOneTask, 1 + rand() % longest, isrFrames, NULL);
+		if (steps > longest) longest = steps;
+	}
+	drain();
+	checkCounts("interleaved");
+	printf("interleaved: %ld task runs, up to %ld instructions each\n", runs, longest);
+}
+
+int main(int argc, char** argv){
+	Uint32 frames = (argc > 1) ? atol(argv[1]) : 2000000L;
+
+	maxFrames = frames + 100000L;
+	seen = malloc(maxFrames);
+	srand(4);
+	ringWrap(frames);
+	heldOff(frames / 4);
+	interleaved(4000);
+	printf(fails ? "FAIL (%d)\n" : "PASS\n", fails);
+	return fails != 0;
+}
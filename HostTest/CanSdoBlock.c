@@ -0,0 +1,396 @@
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+//
+//     CanSdoBlock.c
+//
+// Host loopback test of the SDO block transfers in CanOpen.C, through the
+// real CanComm.C receive ring and transmit queue and the task manager, on
+// the bus ECanSim.c simulates.  A CiA 301 client here downloads to and
+// uploads from 204A.02 (canF_recvDummyFile / canF_sendDummyFile are
+// replaced by a recorder and a payload server), every length 0 - 128 and
+// random ones, and checks every byte and the CRC-16:
+//  - segments lost on the way to us: the ackseq we send back makes the
+//    client re-send from there
+//  - segments the client loses on the way back: its short ackseq makes
+//    canO_blockUploadTask() back up; the bus takes frames off at random
+//    moments while the task queues them
+//  - a bad CRC, an oversize download, an abort in the middle of a block
+//    transfer, and a new request ending a block download
+//
+//     CanSdoBlock [transfers]
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "DSP281x_Device.h"
+#include "stdbool.h"
+#include "CanOpen.H"
+#include "CanComm.H"
+#include "TaskMgr.h"
+#include "ECanSim.h"
+
+#define INDEX 0x204A
+#define SUBINDEX 2
+#define BUF_SIZE 128		// multi_packet_buf.max_char_in_buf
+
+static int fails;
+#define CHECK(c, ...) do { if (!(c)) { printf("FAIL %s:%d ", __FILE__, __LINE__); \
+	printf(__VA_ARGS__); printf("\n"); fails++; } } while (0)
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// 204A.02 and what else CanComm.C calls
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+static unsigned char served[BUF_SIZE], got[BUF_SIZE];
+static int servedLen, gotLen = -1;
+
+enum CANOPEN_STATUS canF_sendDummyFile(const struct CAN_COMMAND* can_command, Uint16* data){
+	struct MULTI_PACKET_BUF* mpb = (struct MULTI_PACKET_BUF*)can_command->datapointer;
+	int i;
+
+	(void)data;
+	for (i = 0; i < servedLen; i++){
+		mpb->buff[i] = served[i];
+	}
+	mpb->count_of_bytes_in_buf = servedLen;
+	return CANOPEN_NO_ERR;
+}
+
+enum CANOPEN_STATUS canF_recvDummyFile(const struct CAN_COMMAND* can_command, Uint16* data){
+	struct MULTI_PACKET_BUF* mpb = (struct MULTI_PACKET_BUF*)can_command->datapointer;
+	int i;
+
+	CHECK((char*)data == mpb->buff, "download handed something other than multi_packet_buf");
+	gotLen = mpb->count_of_bytes_in_buf;
+	for (i = 0; (i < gotLen) && (i < BUF_SIZE); i++){
+		got[i] = mpb->buff[i] & 0xFF;
+	}
+	return CANOPEN_NO_ERR;
+}
+
+void InitECan(void){
+}
+
+void diagRs232CanRecvMsg(Uint16 mbxNumber, Uint16* msg){
+	(void)mbxNumber;
+	(void)msg;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// the bus, from the client's side: frames as 8 bytes, ls byte of MDL first
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+#define INBOX_SIZE 256
+static unsigned char inbox[INBOX_SIZE][8];
+static int inHead, inTail;
+
+static void busTake(void){
+	Uint32 mdl, mdh;
+	int i;
+
+	while (ecanSim_transmit(&mdl, &mdh) >= 0) {
+		for (i = 0; i < 4; i++){
+			inbox[inHead % INBOX_SIZE][i] = (mdl >> (8 * i)) & 0xFF;
+			inbox[inHead % INBOX_SIZE][i + 4] = (mdh >> (8 * i)) & 0xFF;
+		}
+		inHead++;
+	}
+}
+
+// run the firmware until it has nothing left to do, the bus taking frames
+// off at random moments in between
+static void serverRun(void){
+	int n;
+
+	for (n = 0; n < 400; n++){
+		taskMgr_runBkgndTasks();
+		if (rand() % 3 == 0) busTake();
+	}
+	busTake();
+}
+
+static void clientSend(const unsigned char* b){
+	Uint32 mdl = 0, mdh = 0;
+	int i;
+
+	for (i = 0; i < 4; i++){
+		mdl |= (Uint32)b[i] << (8 * i);
+		mdh |= (Uint32)b[i + 4] << (8 * i);
+	}
+	ecanSim_receive(31, mdl, mdh);
+	serverRun();
+}
+
+static int clientRecv(unsigned char* b){
+	if (inTail == inHead) {
+		return 0;
+	}
+	memcpy(b, inbox[inTail++ % INBOX_SIZE], 8);
+	return 1;
+}
+
+static void frame(unsigned char* b, int b0, int b4){
+	memset(b, 0, 8);
+	b[0] = b0;
+	b[1] = INDEX & 0xFF;
+	b[2] = INDEX >> 8;
+	b[3] = SUBINDEX;
+	b[4] = b4;
+}
+
+// CRC-16-CCITT, bit at a time, to check the table one in CanOpen.C
+static Uint16 crc16(const unsigned char* p, int n){
+	Uint16 c = 0;
+	int i, k;
+
+	for (i = 0; i < n; i++){
+		c ^= p[i] << 8;
+		for (k = 0; k < 8; k++){
+			c = (c & 0x8000) ? (c << 1) ^ 0x1021 : (c << 1);
+		}
+	}
+	return c;
+}
+
+// the server's one reply, which must be an abort with this code
+static void expectAbort(const char* what, enum CANOPEN_STATUS code){
+	unsigned char r[8];
+
+	CHECK(clientRecv(r) && (r[0] == 0x80) && (r[4] == code), "%s: reply %02X code %u, expected abort code %d",
+		what, r[0], r[4], code);
+	CHECK(inTail == inHead, "%s: more than one reply", what);
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// block download, n bytes; drop = chance in 8 of losing a segment on the
+// way; badCrc sends the wrong CRC at the end
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+static Uint32 downloads, downloadResends;
+
+static void blockDownload(int n, int drop, int badCrc){
+	unsigned char data[BUF_SIZE + 7], b[8], r[8];
+	int i, segs, acked, blksize, inBlock, lose, s, k, pad;
+	Uint16 crc;
+
+	for (i = 0; i < n; i++){
+		data[i] = rand() & 0xFF;
+	}
+	segs = (n + 6) / 7;
+	if (segs == 0) segs = 1;		// one empty segment carries the c bit
+	gotLen = -1;
+
+	frame(b, 0xC6, n);				// ccs=6, cc=1, s=1, size in bytes 4 - 7
+	clientSend(b);
+	CHECK(clientRecv(r) && (r[0] == 0xA4) && (r[1] == (INDEX & 0xFF)) && (r[2] == (INDEX >> 8)) && (r[3] == SUBINDEX),
+		"download %d: initiate reply %02X", n, r[0]);
+	blksize = r[4];
+	CHECK((blksize >= 1) && (blksize <= 127), "download %d: blksize %d", n, blksize);
+
+	acked = 0;
+	while (acked < segs){
+		inBlock = (segs - acked < blksize) ? segs - acked : blksize;
+		// lose one segment, never the block's last: only that one gets a reply
+		lose = (drop && (inBlock > 1) && (rand() % 8 == 0)) ? 1 + rand() % (inBlock - 1) : 0;
+		for (s = 1; s <= inBlock; s++){
+			k = acked + s - 1;		// segment number in the transfer, 0 up
+			memset(b, 0, 8);
+			b[0] = s | ((k == segs - 1) ? 0x80 : 0);
+			for (i = 0; i < 7; i++){
+				b[1 + i] = (7 * k + i < n) ? data[7 * k + i] : 0;
+			}
+			if (s == lose) {
+				downloadResends++;
+				continue;
+			}
+			clientSend(b);
+			if (s < inBlock) {
+				CHECK(inTail == inHead, "download %d: reply to segment %d of %d", n, s, inBlock);
+			}
+		}
+		CHECK(clientRecv(r) && (r[0] == 0xA2), "download %d: block reply %02X", n, r[0]);
+		CHECK(r[1] == (lose ? lose - 1 : inBlock), "download %d: ackseq %d, lost %d of %d", n, r[1], lose, inBlock);
+		acked += r[1];
+		blksize = r[2];
+		CHECK((blksize >= 1) && (blksize <= 127), "download %d: blksize %d", n, blksize);
+		if (fails > 10) exit(1);
+	}
+
+	pad = 7 * segs - n;
+	crc = crc16(data, n) ^ (badCrc ? 0x0100 : 0);
+	memset(b, 0, 8);
+	b[0] = 0xC1 | (pad << 2);
+	b[1] = crc & 0xFF;
+	b[2] = crc >> 8;
+	clientSend(b);
+	if (badCrc) {
+		expectAbort("download with a bad CRC", CANOPEN_SDO_BLOCK_002_ERR);
+		CHECK(gotLen < 0, "download with a bad CRC: delivered");
+		return;
+	}
+	CHECK(clientRecv(r) && (r[0] == 0xA1), "download %d: end reply %02X", n, r[0]);
+	CHECK(gotLen == n, "download %d: %d bytes delivered", n, gotLen);
+	CHECK((gotLen != n) || (memcmp(got, data, n) == 0), "download %d: data differs", n);
+	downloads++;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// block upload, n bytes; drop = chance in 8 of the client losing a segment
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+static Uint32 uploads, uploadResends;
+
+static void blockUpload(int n, int drop){
+	unsigned char data[BUF_SIZE + 7], b[8], r[8];
+	int i, size, blksize, seq, done, lost, have, pad, segsSeen;
+	Uint16 crc;
+
+	servedLen = n;
+	for (i = 0; i < n; i++){
+		served[i] = rand() & 0xFF;
+	}
+	blksize = 1 + rand() % 127;
+	if (rand() % 2) blksize = 1 + rand() % 4;
+
+	frame(b, 0xA4, blksize);		// ccs=5, cc=1, cs=0, blksize in byte 4
+	clientSend(b);
+	CHECK(clientRecv(r) && (r[0] == 0xC6) && (r[1] == (INDEX & 0xFF)) && (r[2] == (INDEX >> 8)) && (r[3] == SUBINDEX),
+		"upload %d: initiate reply %02X", n, r[0]);
+	size = r[4] | (r[5] << 8) | (r[6] << 16) | (r[7] << 24);
+	CHECK(size == n, "upload %d: size %d", n, size);
+
+	memset(b, 0, 8);
+	b[0] = 0xA3;					// start
+	clientSend(b);
+
+	have = 0;
+	done = 0;
+	while (!done){
+		seq = 0;
+		lost = 0;
+		segsSeen = 0;
+		while (clientRecv(r)){
+			segsSeen++;
+			if (lost || ((r[0] & 0x7F) != seq + 1)) {
+				lost = 1;
+				continue;
+			}
+			if (drop && (rand() % 8 == 0)) {
+				lost = 1;			// this one and what follows never arrive
+				uploadResends++;
+				continue;
+			}
+			seq++;
+			memcpy(data + have, r + 1, 7);
+			have += 7;
+			if (r[0] & 0x80) {
+				done = 1;
+			}
+		}
+		CHECK(segsSeen > 0, "upload %d: block of nothing, %d bytes in", n, have);
+		if (segsSeen == 0) return;
+		CHECK(segsSeen <= blksize, "upload %d: %d segments, blksize %d", n, segsSeen, blksize);
+
+		blksize = 1 + rand() % 127;
+		if (rand() % 2) blksize = 1 + rand() % 4;
+		memset(b, 0, 8);
+		b[0] = 0xA2;				// block acknowledge
+		b[1] = seq;					// ackseq
+		b[2] = blksize;
+		clientSend(b);
+		if (fails > 10) exit(1);
+	}
+
+	CHECK(clientRecv(r) && ((r[0] & 0xE3) == 0xC1), "upload %d: end %02X", n, r[0]);
+	pad = (r[0] >> 2) & 7;
+	crc = r[1] | (r[2] << 8);
+	CHECK(have - pad == n, "upload %d: %d bytes, %d unused in the last segment", n, have, pad);
+	CHECK(crc == crc16(served, n), "upload %d: CRC %04X, expected %04X", n, crc, crc16(served, n));
+	CHECK(memcmp(data, served, n) == 0, "upload %d: data differs", n);
+	memset(b, 0, 8);
+	b[0] = 0xA1;					// end
+	clientSend(b);
+	CHECK(inTail == inHead, "upload %d: reply to the end", n);
+	uploads++;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// transfers cut short
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+static void cutShort(void){
+	unsigned char b[8], r[8];
+
+	// more than the buffer holds
+	frame(b, 0xC6, BUF_SIZE + 1);
+	clientSend(b);
+	expectAbort("download of 129 bytes", CANOPEN_MULTI_SEG_000_ERR);
+
+	// abort in the middle of a block download: no reply, the next one works
+	frame(b, 0xC6, 50);
+	clientSend(b);
+	CHECK(clientRecv(r) && (r[0] == 0xA4), "download to abort: initiate reply %02X", r[0]);
+	memset(b, 0, 8);
+	b[0] = 1;
+	clientSend(b);
+	frame(b, 0x80, 0);
+	clientSend(b);
+	CHECK(inTail == inHead, "reply to an abort");
+	blockDownload(50, 0, 0);
+
+	// abort in the middle of a block upload
+	servedLen = 100;
+	frame(b, 0xA4, 3);
+	clientSend(b);
+	b[0] = 0xA3;
+	clientSend(b);
+	while (clientRecv(r))
+		;
+	frame(b, 0x80, 0);
+	clientSend(b);
+	CHECK(inTail == inHead, "reply to an abort");
+	blockUpload(100, 0);
+
+	// the client gives up on a block download and starts something else
+	frame(b, 0xC6, 30);
+	clientSend(b);
+	CHECK(clientRecv(r) && (r[0] == 0xA4), "download to give up on: initiate reply %02X", r[0]);
+	frame(b, 0x40, 0);				// expedited upload, 205A.06
+	b[1] = 0x5A;
+	b[2] = 0x20;
+	b[3] = 6;
+	clientSend(b);
+	CHECK(clientRecv(r) && (r[0] == 0x43) && (r[1] == 0x5A) && (r[3] == 6), "expedited upload during block download: reply %02X", r[0]);
+	blockDownload(30, 0, 0);
+
+	// bad CRC
+	blockDownload(77, 0, 1);
+}
+
+int main(int argc, char** argv){
+	long transfers = (argc > 1) ? atol(argv[1]) : 20000L;
+	long i;
+	int n;
+
+	srand(6);
+	ecanSim_reset();
+	taskMgr_init();
+	canC_initComm();
+	canC_store_int_vectors_in_PIE();
+	canC_enable_interrupt();
+
+	for (n = 0; n <= BUF_SIZE; n++){
+		blockDownload(n, 0, 0);
+		blockUpload(n, 0);
+	}
+	cutShort();
+	for (i = 0; i < transfers; i++){
+		n = rand() % (BUF_SIZE + 1);
+		if (rand() % 2) {
+			blockDownload(n, 1, 0);
+		} else {
+			blockUpload(n, 1);
+		}
+	}
+	CHECK(canC_txQueueFullCount == 0, "%lu frames dropped with the transmit queue full", (unsigned long)canC_txQueueFullCount);
+	printf("%lu downloads, %lu segments lost on the way in; %lu uploads, %lu lost on the way out\n",
+		(unsigned long)downloads, (unsigned long)downloadResends, (unsigned long)uploads, (unsigned long)uploadResends);
+	printf(fails ? "FAIL (%d)\n" : "PASS\n", fails);
+	return fails != 0;
+}
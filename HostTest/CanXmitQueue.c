@@ -0,0 +1,291 @@
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+//
+//     CanXmitQueue.c
+//
+// Host test of the eCAN transmit path: canC_transmitMessage() queueing
+// frames in canTxQueue[], canC_txLoadMailboxes() moving them into Tx
+// mailboxes 4 - 15 (CANTRS; 0 - 3 are the TPDOs' and never take a queued
+// frame), and canC_xmitIsr() reloading them when the bus has taken a frame
+// (CANTA) or a request was aborted (CANAA).  ECanSim.c plays the bus, taking
+// the pending mailbox with the highest TPL.  Each frame carries a sequence
+// number.  Frames must reach the bus intact, in the order they were queued,
+// each at most once; every frame queued must be sent, aborted
+// (canC_txAbortCount) or refused because the queue was full
+// (canC_txQueueFullCount); and nothing may be left waiting once the bus
+// goes quiet.
+//  1. bursts: the background queueing runs of frames, the bus taking a few
+//     at a time, the queue filling now and then
+//  2. aborts: CANTRR writes aborting some or all pending mailboxes,
+//     including every one of them while mailbox 4 has been used and frames
+//     are waiting in the queue -- only the abort interrupt reloads then
+//  3. frames leaving the bus from an interrupt between any two instructions
+//     of canC_transmitMessage() (SingleStep.c)
+//
+//     CanXmitQueue [frames]
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "DSP281x_Device.h"
+#include "CanOpen.H"
+#include "CanComm.H"
+#include "ECanSim.h"
+#include "SingleStep.h"
+
+#define QUEUE_SLOTS 31		// CAN_TX_QUEUE_SIZE - 1 frames fit
+#define TX_MAILBOXES 0x0000FFF0L	// the queue's, 4 - 15
+#define LAST_MAILBOX 0x00000010L	// the last one in a countdown from 15
+
+static int fails;
+#define CHECK(c, ...) do { if (!(c)) { printf("FAIL %s:%d ", __FILE__, __LINE__); \
+	printf(__VA_ARGS__); printf("\n"); fails++; } } while (0)
+
+static Uint32 queued, onBus, aborted, refused;
+static Uint32 nextSeq;				// next sequence number expected on the bus
+static unsigned char* fate;			// per frame: 0 not yet, 1 sent, 2 aborted, 3 refused
+static Uint32 maxFrames;
+
+static Uint32 frameCheck(Uint32 seq){
+	return (seq * 2654435761u) ^ 0x5A5A3C3Cu;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// what CanComm.C calls on the receive side, not used here
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void InitECan(void){
+}
+
+void diagRs232CanRecvMsg(Uint16 mbxNumber, Uint16* msg){
+	(void)mbxNumber;
+	(void)msg;
+}
+
+enum CANOPEN_STATUS canO_HandleCanOpenMessage(Uint16* rcvMsg, Uint16* xmtMsg){
+	(void)rcvMsg;
+	(void)xmtMsg;
+	CHECK(0, "a frame was received");
+	return CANOPEN_NO_ERR;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// both ends
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+static void queueFrame(void){
+	Uint16 msg[4];
+	Uint32 full = canC_txQueueFullCount;
+	Uint32 seq = queued++;
+
+	msg[0] = (Uint16)seq;
+	msg[1] = (Uint16)(seq >> 16);
+	msg[2] = (Uint16)frameCheck(seq);
+	msg[3] = (Uint16)(frameCheck(seq) >> 16);
+	canC_transmitMessage(msg);
+	if (canC_txQueueFullCount != full) {
+		fate[seq] = 3;
+		refused++;
+	}
+}
+
+static Uint32 frameSeq(Uint32 mdl, Uint32 mdh){
+	if ((mdl >= queued) || (mdh != frameCheck(mdl))) {
+		CHECK(0, "torn frame: seq %lu check %08lX", (unsigned long)mdl, (unsigned long)mdh);
+		exit(1);
+	}
+	return mdl;
+}
+
+// the bus takes one frame, returns 0 if there was none
+static int busStep(void){
+	Uint32 mdl, mdh, seq;
+	int mbx;
+
+	if ((mbx = ecanSim_transmit(&mdl, &mdh)) < 0) {
+		return 0;
+	}
+	CHECK((TX_MAILBOXES >> mbx) & 1, "queued frame sent from mailbox %d", mbx);
+	seq = frameSeq(mdl, mdh);
+	CHECK(fate[seq] == 0, "frame %lu on the bus, fate %u", (unsigned long)seq, fate[seq]);
+	CHECK(seq >= nextSeq, "frame %lu on the bus after frame %lu", (unsigned long)seq, (unsigned long)nextSeq - 1);
+	fate[seq] = 1;
+	nextSeq = seq + 1;
+	onBus++;
+	if (fails > 10) exit(1);
+	return 1;
+}
+
+static void busQuiet(void){
+	while (busStep())
+		;
+}
+
+// abort the pending requests in these mailboxes, as a CANTRR write does
+static void abortMailboxes(Uint32 mask){
+	Uint32 pending = ECanaRegs.CANTRS.all & mask;
+	Uint32 seq;
+	int mbx;
+
+	for (mbx = 0; mbx < 16; mbx++){
+		if (pending & (1L << mbx)) {
+			seq = frameSeq((&ECanaMboxes.MBOX0)[mbx].MDL.all, (&ECanaMboxes.MBOX0)[mbx].MDH.all);
+			CHECK(fate[seq] == 0, "frame %lu aborted, fate %u", (unsigned long)seq, fate[seq]);
+			fate[seq] = 2;
+			aborted++;
+		}
+	}
+	write32((Uint32*)&ECanaRegs.CANTRR.all, mask);
+	ecanSim_raiseInterrupts();
+}
+
+static void start(void){
+	ecanSim_reset();
+	canC_initComm();
+	canC_store_int_vectors_in_PIE();
+	canC_enable_interrupt();
+	queued = onBus = aborted = refused = nextSeq = 0;
+	memset(fate, 0, maxFrames);
+}
+
+static void checkCounts(const char* phase){
+	Uint32 seq, lost = 0;
+
+	busQuiet();
+	CHECK(canC_txQueueSpace() == QUEUE_SLOTS, "%s: %u frames left in the queue", phase, QUEUE_SLOTS - canC_txQueueSpace());
+	CHECK((ECanaRegs.CANTRS.all & TX_MAILBOXES) == 0, "%s: CANTRS %08lX", phase, (unsigned long)ECanaRegs.CANTRS.all);
+	CHECK((ECanaRegs.CANTA.all | ECanaRegs.CANAA.all) == 0, "%s: CANTA %08lX CANAA %08lX not cleared", phase,
+		(unsigned long)ECanaRegs.CANTA.all, (unsigned long)ECanaRegs.CANAA.all);
+	for (seq = 0; seq < queued; seq++){
+		if (fate[seq] == 0) lost++;
+	}
+	CHECK(lost == 0, "%s: %lu frames neither sent, aborted nor refused", phase, (unsigned long)lost);
+	CHECK(canC_txFrameCount == onBus, "%s: canC_txFrameCount %lu, %lu on the bus", phase,
+		(unsigned long)canC_txFrameCount, (unsigned long)onBus);
+	CHECK(canC_txAbortCount == aborted, "%s: canC_txAbortCount %lu, %lu aborted", phase,
+		(unsigned long)canC_txAbortCount, (unsigned long)aborted);
+	CHECK(canC_txQueueFullCount == refused, "%s: canC_txQueueFullCount %lu, %lu refused", phase,
+		(unsigned long)canC_txQueueFullCount, (unsigned long)refused);
+	CHECK(canC_txQueueHighWater <= QUEUE_SLOTS, "%s: high water %lu", phase, (unsigned long)canC_txQueueHighWater);
+	CHECK((refused == 0) || (canC_txQueueHighWater == QUEUE_SLOTS), "%s: frames refused, high water only %lu", phase,
+		(unsigned long)canC_txQueueHighWater);
+	printf("%s: %lu frames, %lu sent, %lu aborted, %lu refused with the queue full, high water %lu\n",
+		phase, (unsigned long)queued, (unsigned long)onBus, (unsigned long)aborted, (unsigned long)refused,
+		(unsigned long)canC_txQueueHighWater);
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// 1. bursts
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+static void bursts(Uint32 frames){
+	int n, count;
+
+	start();
+	while (queued < frames){
+		count = (rand() % 16 == 0) ? 40 + rand() % 20 : 1 + rand() % 20;
+		for (n = 0; n < count; n++){
+			// most senders pace themselves with canC_txQueueSpace()
+			if ((canC_txQueueSpace() == 0) && (rand() % 4 != 0)) break;
+			queueFrame();
+		}
+		count = rand() % 24;
+		for (n = 0; n < count; n++){
+			busStep();
+		}
+	}
+	checkCounts("bursts");
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// 2. aborts
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+static void aborts(Uint32 frames){
+	int n, count, stalls = 0;
+
+	start();
+	while (queued < frames){
+		count = 1 + rand() % 40;
+		for (n = 0; n < count; n++){
+			queueFrame();
+		}
+		count = rand() % 20;
+		for (n = 0; n < count; n++){
+			busStep();
+		}
+		switch (rand() % 4){
+		case 0:
+			abortMailboxes(1L << (4 + rand() % 12));
+			break;
+		case 1:
+			abortMailboxes((Uint32)rand() & TX_MAILBOXES);
+			break;
+		case 2:
+			// mailbox 4 taken, frames waiting in the queue: abort every
+			// pending request, then see that the queue moves without
+			// anything more being queued
+			if ((ECanaRegs.CANTRS.all & LAST_MAILBOX) && (canC_txQueueSpace() < QUEUE_SLOTS)) {
+				abortMailboxes(TX_MAILBOXES);
+				CHECK((ECanaRegs.CANTRS.all & TX_MAILBOXES) != 0, "aborts: queue of %u frames stalled after every mailbox was aborted",
+					QUEUE_SLOTS - canC_txQueueSpace());
+				stalls++;
+			}
+			break;
+		default:
+			break;
+		}
+	}
+	checkCounts("aborts");
+	CHECK(stalls > 100, "aborts: only %d aborts with the queue waiting", stalls);
+	printf("aborts: every mailbox aborted %d times with the queue waiting\n", stalls);
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// 3. frames leaving the bus anywhere in canC_transmitMessage()
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+static void busIsr(void){
+	int n, count = 1 + rand() % 3;
+
+	for (n = 0; n < count; n++){
+		busStep();
+	}
+}
+
+static void interleaved(long runs){
+	long i, steps, longest = 1;
+	int mbx;
+
+	start();
+	for (i = 0; i < runs; i++){
+		// some mailboxes pending, sometimes mailbox 4 among them, sometimes
+		// the queue nearly full
+		while ((ECanaRegs.CANTRS.all & TX_MAILBOXES) == 0) {
+			queueFrame();
+		}
+		if (rand() % 4 == 0) {
+			while ((canC_txQueueSpace() > rand() % 3) && (queued < maxFrames - 1)) {
+				queueFrame();
+			}
+		} else if (rand() % 2) {
+			for (mbx = rand() % 8; mbx > 0; mbx--){
+				busStep();
+			}
+		}
+		steps = singleStep_run(queueFrame, 1 + rand() % longest, busIsr, NULL);
+		if (steps > longest) longest = steps;
+		if (rand() % 8 == 0) busQuiet();
+	}
+	checkCounts("interleaved");
+	printf("interleaved: %ld frames queued single-stepped, up to %ld instructions each\n", runs, longest);
+}
+
+int main(int argc, char** argv){
+	Uint32 frames = (argc > 1) ? atol(argv[1]) : 2000000L;
+
+	maxFrames = frames + 200000L;
+	fate = malloc(maxFrames);
+	srand(5);
+	bursts(frames);
+	aborts(frames / 4);
+	interleaved(4000);
+	printf(fails ? "FAIL (%d)\n" : "PASS\n", fails);
+	return fails != 0;
+}
@@ -0,0 +1,146 @@
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+//
+//     ECanSim.c
+//
+// See ECanSim.h.
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+#include <string.h>
+
+#include "DSP281x_Device.h"
+#include "ECanSim.h"
+
+int ecanSim_holdInterrupts;
+
+void ecanSim_reset(void){
+	memset((void*)&ECanaRegs, 0, sizeof ECanaRegs);
+	memset((void*)&ECanaMboxes, 0, sizeof ECanaMboxes);
+	ecanSim_holdInterrupts = 0;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// access32.asm and WorkAround.asm, with the eCAN's write semantics
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+static int isWrite1ToClear(Uint32* addr){
+	return (addr == (Uint32*)&ECanaRegs.CANTA.all)
+		|| (addr == (Uint32*)&ECanaRegs.CANAA.all)
+		|| (addr == (Uint32*)&ECanaRegs.CANRMP.all);
+}
+
+static int isWrite1ToSet(Uint32* addr){
+	return (addr == (Uint32*)&ECanaRegs.CANTRS.all)
+		|| (addr == (Uint32*)&ECanaRegs.CANTRR.all);
+}
+
+Uint32 read32(Uint32* addr){
+	return *(volatile Uint32*)addr;
+}
+
+void write32(Uint32* addr, Uint32 value){
+	volatile Uint32* reg = addr;
+
+	if (isWrite1ToClear(addr)) {
+		*reg &= ~value;
+		if (addr == (Uint32*)&ECanaRegs.CANRMP.all) {
+			ECanaRegs.CANRML.all &= ~value;	// read-only, cleared with CANRMP
+		}
+	} else if (addr == (Uint32*)&ECanaRegs.CANTRR.all) {
+		ECanaRegs.CANAA.all |= ECanaRegs.CANTRS.all & value;	// abort acknowledged
+		ECanaRegs.CANTRS.all &= ~value;
+	} else if (isWrite1ToSet(addr)) {
+		*reg |= value;
+	} else {
+		*reg = value;
+	}
+}
+
+// read-modify-write, as the assembly does it -- on a write-1-to-clear
+// register that clears every bit that was set, not just these
+void setbits32(Uint32* addr, Uint32 bits){
+	write32(addr, read32(addr) | bits);
+}
+
+void clearbits32(Uint32* addr, Uint32 bits){
+	write32(addr, read32(addr) & ~bits);
+}
+
+// WorkAround.asm
+void CanDoubleRead(Uint32* StorePtr, volatile Uint32* RegPtr){
+	*StorePtr = read32((Uint32*)RegPtr);
+}
+
+void CanDoubleWrite(volatile Uint32* RegPtr, Uint32* LoadPtr){
+	write32((Uint32*)RegPtr, *LoadPtr);
+}
+
+void CanDoubleClear(volatile Uint32* RegPtr, Uint32* LoadPtr){
+	clearbits32((Uint32*)RegPtr, *LoadPtr);
+}
+
+void CanDoubleSet(volatile Uint32* RegPtr, Uint32* LoadPtr){
+	setbits32((Uint32*)RegPtr, *LoadPtr);
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// bus side
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void ecanSim_raiseInterrupts(void){
+	Uint32 pending = (ECanaRegs.CANRMP.all | ECanaRegs.CANTA.all) & ECanaRegs.CANMIM.all;
+	Uint32 line1 = ECanaRegs.CANMIL.all;
+	Uint32 gim = ECanaRegs.CANGIM.all;
+	int aborted = (ECanaRegs.CANAA.all != 0) && (gim & 0x00004000L);	// AAIM
+	int globalLine1 = (gim & 0x00000004L) != 0;							// GIL
+
+	if (((pending & ~line1) || (aborted && !globalLine1))
+	 && (gim & 0x00000001L) && PieCtrlRegs.PIEIER9.bit.INTx5 && PieVectTable.ECAN0INTA) {
+		PieVectTable.ECAN0INTA();
+	}
+	if (((pending & line1) || (aborted && globalLine1))
+	 && (gim & 0x00000002L) && PieCtrlRegs.PIEIER9.bit.INTx6 && PieVectTable.ECAN1INTA) {
+		PieVectTable.ECAN1INTA();
+	}
+}
+
+void ecanSim_receive(Uint16 mbxNumber, Uint32 mdl, Uint32 mdh){
+	volatile struct MBOX* mp = &(&ECanaMboxes.MBOX0)[mbxNumber];
+	Uint32 bit = 1L << mbxNumber;
+
+	mp->MDL.all = mdl;
+	mp->MDH.all = mdh;
+	if (ECanaRegs.CANRMP.all & bit) {
+		ECanaRegs.CANRML.all |= bit;	// overwrote an unread frame
+	}
+	ECanaRegs.CANRMP.all |= bit;
+	if (!ecanSim_holdInterrupts) {
+		ecanSim_raiseInterrupts();
+	}
+}
+
+int ecanSim_transmit(Uint32* mdl, Uint32* mdh){
+	Uint32 waiting = ECanaRegs.CANTRS.all & ECanaRegs.CANME.all & ~ECanaRegs.CANMD.all;
+	volatile struct MBOX* mp;
+	int mbx, best = -1;
+	Uint16 tpl, bestTpl = 0;
+
+	for (mbx = 0; mbx < 32; mbx++){
+		if (waiting & (1L << mbx)) {
+			tpl = ((&ECanaMboxes.MBOX0)[mbx].MSGCTRL.all >> 8) & 0x1F;
+			if ((best < 0) || (tpl >= bestTpl)) {
+				best = mbx;
+				bestTpl = tpl;
+			}
+		}
+	}
+	if (best < 0) {
+		return -1;
+	}
+	mp = &(&ECanaMboxes.MBOX0)[best];
+	*mdl = mp->MDL.all;
+	*mdh = mp->MDH.all;
+	ECanaRegs.CANTRS.all &= ~(1L << best);
+	ECanaRegs.CANTA.all |= 1L << best;
+	if (!ecanSim_holdInterrupts) {
+		ecanSim_raiseInterrupts();
+	}
+	return best;
+}
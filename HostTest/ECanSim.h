@@ -0,0 +1,55 @@
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+//
+//     ECanSim.h
+//
+// The eCAN module as far as the host tests need it.  ECanaRegs and
+// ECanaMboxes are plain memory (HostRegs.c).  ECanSim.c supplies the
+// access32.asm and WorkAround.asm routines, through which the firmware
+// gets the hardware's write semantics: CANTA, CANAA and CANRMP
+// are write-1-to-clear (clearing CANRMP clears CANRML), CANTRS and CANTRR
+// write-1-to-set.  Writing CANTRR aborts those requests at once (no frame is
+// ever caught half sent here): CANTRS cleared, CANAA set.  And the bus side:
+// frames arriving in receive mailboxes, frames leaving transmit mailboxes,
+// and the interrupts they raise.
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+#ifndef ECANSIM_H
+#define ECANSIM_H
+
+// clear every register, mailbox and count
+void ecanSim_reset(void);
+
+// A frame arrives in receive mailbox mbxNumber: data into MDL/MDH, CANRMP
+// set, CANRML too if the last frame there was still unread.  Raises the
+// mailbox interrupt if CANMIM/CANMIL/CANGIM route it to a line whose PIE
+// vector is installed, unless ecanSim_holdInterrupts is set.
+void ecanSim_receive(Uint16 mbxNumber, Uint32 mdl, Uint32 mdh);
+
+// The bus takes the next frame: of the enabled transmit mailboxes with
+// CANTRS set, the one with the highest TPL (the higher mailbox number on a
+// tie).  Its MDL/MDH into *mdl / *mdh, CANTRS cleared, CANTA set, interrupt
+// raised as for ecanSim_receive().  Returns the mailbox number, -1 if no
+// frame was waiting.
+int ecanSim_transmit(Uint32* mdl, Uint32* mdh);
+
+// Raise eCAN interrupt line 0 / 1 now if anything is pending for it:
+// CANRMP or CANTA bits CANMIM lets through, CANMIL choosing the line, and
+// the abort-acknowledge interrupt (CANAA, if CANGIM.AAIM) on the line
+// CANGIM.GIL chooses.
+void ecanSim_raiseInterrupts(void);
+
+// Set to keep ecanSim_receive() from raising interrupts, as when the CPU
+// has them masked.
+extern int ecanSim_holdInterrupts;
+
+// access32.asm
+Uint32 read32(Uint32* addr);
+void write32(Uint32* addr, Uint32 value);
+void setbits32(Uint32* addr, Uint32 bits);
+void clearbits32(Uint32* addr, Uint32 bits);
+
+// WorkAround.asm (CanDoubleRead / CanDoubleWrite are in DSP281x_ECan.h)
+void CanDoubleClear(volatile Uint32* RegPtr, Uint32* LoadPtr);
+void CanDoubleSet(volatile Uint32* RegPtr, Uint32* LoadPtr);
+
+#endif
@@ -0,0 +1,206 @@
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+//
+//     EnDatCrc5.c
+//
+// Host test for the table-driven EnDat CRC-5 and position bit reversal in
+// F2Int.c, against the bit-at-a-time versions they replaced (copied here
+// as they were).
+//  - f2i_CRC5(): every input for every length of 0 - 26 bits (0 - 32 with
+//    the argument 32, a few minutes more), the bits past the length set to
+//    junk that must not matter; the longer ones up to 40 bits (0 fill
+//    after the 32 data bits) at random and with every single bit set
+//  - f2i_SSEnc_reverse_position(): every position for widths 0 - 24, both
+//    alarm bit values, junk above the width; widths 25 - 31 at random and
+//    with every single bit set
+// The old CRC is affine in the data bits, so walking all 2^n inputs in
+// Gray code order keeps the expected CRC current with one XOR a step;
+// the old code itself checks a sample of those steps, and every random
+// case.
+//
+//     EnDatCrc5 [all inputs up to this many bits]
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "DSP281x_Device.h"
+#include "CanOpen.H"
+#include "F2Int.H"
+
+static int fails;
+#define CHECK(c, ...) do { if (!(c)) { printf("FAIL %s:%d ", __FILE__, __LINE__); \
+	printf(__VA_ARGS__); printf("\n"); fails++; if (fails > 10) exit(1); } } while (0)
+
+static Uint32 random32(void){
+	return ((Uint32)rand() << 16) ^ (Uint32)rand() ^ ((Uint32)rand() << 31);
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// the bit-at-a-time versions F2Int.c had before
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+static Uint16 oldCRC5(Uint16 data_1, Uint16 data_2, Uint16 num_bits){
+	Uint16 EnDat_CRC_Reg;
+	Uint16 i;
+	Uint16 j;
+	Uint16 data_byte[5];
+	Uint16 count;
+
+	EnDat_CRC_Reg = 0x1F;
+	count = num_bits;
+
+	data_byte[0] = (data_1 >> 8) & 0x00FF;
+	data_byte[1] = data_1 & 0x00FF;
+	data_byte[2] = (data_2 >> 8) & 0x00FF;
+	data_byte[3] = data_2 & 0x00FF;
+	data_byte[4] = 0;
+
+	for (j=0;j<5;j++){
+		for (i=0;(i<8)&(count>0);i++){
+			count--;
+			EnDat_CRC_Reg = (EnDat_CRC_Reg << 1) & 0x3E;
+			if (((EnDat_CRC_Reg >> 5) ^ (data_byte[j] >> 7))& 0x0001) {
+				EnDat_CRC_Reg = EnDat_CRC_Reg ^ 0x000B;
+			}
+			data_byte[j] = (data_byte[j] << 1) & 0x00FE;
+		}
+	}
+	return ((EnDat_CRC_Reg & 0x001F) ^ 0x001F);
+}
+
+static Uint32 oldReversePosition(Uint32 pos, Uint16 numPosBits, Uint16 alarmBit){
+	Uint16 i;
+	Uint32 reversedPos;
+
+	reversedPos = alarmBit & 0x0001;
+	for (i=numPosBits;i>0;i--){
+		reversedPos = (reversedPos << 1) & 0xFFFFFFFE;
+		reversedPos = reversedPos | (pos & 0x00000001);
+		pos = pos >> 1;
+	}
+	for (i=(31 - numPosBits);i>0;i--){
+		reversedPos = (reversedPos << 1) & 0xFFFFFFFE;
+	}
+	return reversedPos;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// CRC
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+static Uint16 crcOf(Uint32 data, Uint16 n){
+	return f2i_CRC5((Uint16)(data >> 16), (Uint16)data, n);
+}
+
+static Uint16 oldCrcOf(Uint32 data, Uint16 n){
+	return oldCRC5((Uint16)(data >> 16), (Uint16)data, n);
+}
+
+// all 2^n values of the first n bits (MS bit first), junk in the rest
+static void crcAllInputs(Uint16 n){
+	Uint16 basis[32], expect;
+	Uint32 used = n ? 0xFFFFFFFFL << (32 - n) : 0;
+	Uint32 junk = random32() & ~used;
+	Uint32 data, step, steps = n ? ((Uint32)1 << (n - 1) << 1) - 1 : 0;
+	Uint16 i, bit;
+
+	for (i = 0; i < n; i++){
+		basis[i] = oldCrcOf(0, n) ^ oldCrcOf(0x80000000L >> i, n);
+	}
+	data = 0;
+	expect = oldCrcOf(junk, n);
+	step = 0;
+	for (;;){
+		if (crcOf(data | junk, n) != expect) {
+			CHECK(0, "CRC of %08lX, %u bits: %02X, old code %02X", (unsigned long)(data | junk), n,
+				crcOf(data | junk, n), oldCrcOf(data | junk, n));
+		}
+		if ((step & 0xFFFF) == 0) {
+			CHECK(expect == oldCrcOf(data | junk, n), "%u bits: affine walk disagrees with the old code at %08lX",
+				n, (unsigned long)data);
+			junk = random32() & ~used;		// new junk, which must not matter
+			expect = oldCrcOf(data | junk, n);
+		}
+		if (step == steps) break;
+		step++;
+		bit = __builtin_ctz(step);			// Gray code: flip one bit a step
+		data ^= 0x80000000L >> (n - 1 - bit);
+		expect ^= basis[n - 1 - bit];
+	}
+}
+
+static void crcLongInputs(Uint16 from, long samples){
+	Uint16 n, i;
+	Uint32 data;
+	long k;
+
+	for (n = from; n <= 40; n++){
+		for (i = 0; i < 32; i++){
+			data = 0x80000000L >> i;
+			CHECK(crcOf(data, n) == oldCrcOf(data, n), "CRC of %08lX, %u bits: %02X, old code %02X",
+				(unsigned long)data, n, crcOf(data, n), oldCrcOf(data, n));
+		}
+		for (k = 0; k < samples; k++){
+			data = random32();
+			CHECK(crcOf(data, n) == oldCrcOf(data, n), "CRC of %08lX, %u bits: %02X, old code %02X",
+				(unsigned long)data, n, crcOf(data, n), oldCrcOf(data, n));
+		}
+	}
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// position
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+static void checkPosition(Uint32 pos, Uint16 width, Uint16 alarm){
+	Uint32 expect = oldReversePosition(pos, width, alarm);
+	Uint32 got;
+
+	f2i_SSEnc_Pos_32 = pos;
+	f2i_SSEnc_Num_Pos_Bits = width;
+	f2i_SSEnc_Alarm_Bit = alarm;
+	f2i_SSEnc_reverse_position();
+	got = ((Uint32)f2i_SSEnc_Pos_1 << 16) | f2i_SSEnc_Pos_2;
+	if (got != expect) {
+		CHECK(0, "position %08lX, %u bits, alarm %u: %08lX, old code %08lX", (unsigned long)pos, width, alarm,
+			(unsigned long)got, (unsigned long)expect);
+	}
+}
+
+static void positions(long samples){
+	Uint16 width, alarm, i;
+	Uint32 pos, junk, count;
+	long k;
+
+	for (width = 0; width <= 31; width++){
+		for (alarm = 0; alarm < 2; alarm++){
+			if (width <= 24) {
+				count = (Uint32)1 << width;
+				for (pos = 0; pos < count; pos++){
+					junk = ((pos & 0xFF) == 0) ? random32() & ~(count - 1) : junk;
+					checkPosition(pos | junk, width, alarm);
+				}
+			} else {
+				for (i = 0; i < 32; i++){
+					checkPosition((Uint32)1 << i, width, alarm);
+				}
+				for (k = 0; k < samples; k++){
+					checkPosition(random32(), width, alarm);
+				}
+			}
+		}
+	}
+}
+
+int main(int argc, char** argv){
+	Uint16 n, allBits = (argc > 1) ? atoi(argv[1]) : 26;
+
+	srand(7);
+	if (allBits > 32) allBits = 32;
+	for (n = 0; n <= allBits; n++){
+		crcAllInputs(n);
+	}
+	crcLongInputs(allBits + 1, 1000000L);
+	printf("f2i_CRC5: every input of 0 - %u bits, %u - 40 bits sampled\n", allBits, allBits + 1);
+	positions(1000000L);
+	printf("f2i_SSEnc_reverse_position: every position of widths 0 - 24, 25 - 31 sampled\n");
+	printf(fails ? "FAIL (%d)\n" : "PASS\n", fails);
+	return fails != 0;
+}
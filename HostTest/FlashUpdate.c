@@ -0,0 +1,320 @@
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+//
+//     FlashUpdate.c
+//
+// Host test and timing for putting a new image in the SPI flash: the
+// sector erase (0x204C.24, frw_eraseSectorsRecv() and MiscFlashTasks) and
+// the "fast" download (0x204C.04 = 1, data through 0x204C.1B) into both
+// halves of fastRWBuff, against SpiFlashSim.c keeping the M25P40's times.
+//  1. update time: the PC erases, polling every ERASE_POLL_US, then sends
+//     128 bytes per CAN_BLOCK_US, polling 0x204C.05 every POLL_US while
+//     there is no room.  Sector erase and both halves, against a bulk
+//     erase (0x204C.07) and one half -- the next block held until the
+//     last one has gone to the flash, as the single 64-word fastRWBuff
+//     had it.  The image must be in flash byte for byte, the sectors it
+//     does not cover untouched by the sector erase, one page program per
+//     block.  With both halves the download takes as long as the CAN
+//     blocks or the page programs, whichever are slower, and a few
+//     background passes a block -- the PC no longer waits on a poll for
+//     room when the CAN blocks are slower -- and MiscFlashTasks polls an
+//     erase from the scheduler, not on every background pass
+//  2. 0x204C.24: the erase token, the sector range, refused while an erase
+//     or a block of download data is under way, and a download start
+//     refused during an erase; taken after a finished fast download or an
+//     abandoned algorithm 0 one; the count of sectors still to erase
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "DSP281x_Device.h"
+#include "stdbool.h"
+#include "CanOpen.H"
+#include "FlashRW.H"
+#include "TaskMgr.h"
+#include "SpiFlashSim.h"
+
+// FlashRW.C internals
+extern Uint16 mcsFileRecvStatus;
+extern Uint16 fastRWBuffHalvesFull;
+extern enum MISC_FLASH_TASK_OPERATION miscFlashTaskOperation;
+
+#define US_PER_PASS    20.0		// one pass of the background loop
+#define CAN_BLOCK_US   4000.0	// 128 bytes in an SDO transfer
+#define POLL_US        1000.0	// a 0x204C.05 poll, request and reply
+#define ERASE_POLL_US  100000.0
+#define TPP_TYP_US     800.0	// M25P40 data sheet
+#define TPP_MAX_US     5000.0
+#define TSE_TYP_US     600000.0
+#define TBE_TYP_US     4500000.0
+#define BLOCK          128
+#define PASSES_PER_BLOCK 10		// MiscFlashTasks, from WIP clear to the next page program
+#define GIVE_UP_US     60e6
+#define WIP            0x01
+
+static int fails;
+#define CHECK(c, ...) do { if (!(c)) { printf("FAIL %s:%d ", __FILE__, __LINE__); \
+	printf(__VA_ARGS__); printf("\n"); fails++; if (fails > 10) exit(1); } } while (0)
+
+static struct MULTI_PACKET_BUF mpb;
+static unsigned char image[0x30000L];
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// the DSP's background loop and the PC, on the flash's time
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+static double nextTickUs;
+
+static void runFor(double us){
+	double until = spiFlashSim_us + us;
+
+	while (spiFlashSim_us < until){
+		taskMgr_runBkgndTasks();
+		spiFlashSim_us += US_PER_PASS;
+		if (spiFlashSim_us >= nextTickUs) {
+			nextTickUs += 1000;
+			taskMgr_tickDelayWheel();
+		}
+	}
+}
+
+static void powerUp(void){
+	long i;
+
+	spiFlashSim_reset();
+	for (i = 0; i < SPI_FLASH_SIM_BYTES; i++){
+		spiFlashSim_mem[i] = (unsigned char)(i >> 8) ^ (unsigned char)i;	// the images there before
+	}
+	taskMgr_init();
+	frw_SpiFlashInit();
+	miscFlashTaskOperation = MISC_FLASH_TASK_NO_OP;
+	nextTickUs = 1000;
+}
+
+static Uint16 eraseToken(void){
+	Uint16 data[4] = {0, 0, 0, 0};
+
+	CpuTimer0Regs.TIM.half.LSW = rand();
+	frw_bulkEraseFlashSend(NULL, data);
+	return data[2];
+}
+
+static enum CANOPEN_STATUS eraseSectors(Uint16 token, Uint16 first, Uint16 last){
+	Uint16 data[4] = {0, 0, 0, 0};
+
+	data[2] = token;
+	data[3] = first | (last << 8);
+	return frw_eraseSectorsRecv(NULL, data);
+}
+
+static Uint16 sectorsLeft(void){
+	Uint16 data[4] = {0, 0, 0, 0};
+
+	frw_eraseSectorsSend(NULL, data);
+	return data[2];
+}
+
+static enum CANOPEN_STATUS startDownload(Uint16 algorithm, Uint32 offset){
+	Uint16 data[4] = {0, 0, algorithm, 0};
+	enum CANOPEN_STATUS s = frw_startMcsFileRecv(NULL, data);
+
+	frwFlashAddr.all = offset;					// 0x204C.01
+	return s;
+}
+
+// 0x204C.05: room for how many bytes, and the flash status
+static int room(Uint16* flashStatus){
+	Uint16 data[4] = {0, 0, 0, 0};
+
+	frw_mcsFileRecvStatus(NULL, data);
+	if (flashStatus != NULL) *flashStatus = data[2] >> 8;
+	return data[2] & 0x00FF;
+}
+
+static enum CANOPEN_STATUS sendBlock(const unsigned char* bytes, Uint16 count){
+	memcpy(mpb.buff, bytes, count);
+	mpb.count_of_bytes_in_buf = count;
+	return frw_fastFileRecvData(NULL, (Uint16*)mpb.buff);
+}
+
+static int flashIdle(void){
+	return (fastRWBuffHalvesFull == 0) && (miscFlashTaskOperation == MISC_FLASH_TASK_NO_OP);
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// 1. update time
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+struct UPDATE {
+	double eraseUs;
+	double downloadUs;
+	long statusReadsErasing;
+};
+
+// len bytes (a multiple of BLOCK) at offset (sector aligned); sectorErase
+// and both halves of fastRWBuff, or bulk erase and one
+static struct UPDATE update(long len, Uint32 offset, int sectorErase, double tppUs){
+	struct UPDATE u;
+	Uint16 flashStatus;
+	long pos, i;
+	double startUs;
+
+	powerUp();
+	spiFlashSim_tppUs = tppUs;
+	for (i = 0; i < len; i++){
+		image[i] = rand();
+	}
+
+	if (sectorErase) {
+		CHECK(eraseSectors(eraseToken(), offset >> 16, (offset + len - 1) >> 16) == CANOPEN_NO_ERR, "sector erase refused");
+		do {
+			runFor(ERASE_POLL_US);
+		} while ((sectorsLeft() != 0) && (spiFlashSim_us < GIVE_UP_US));
+	} else {
+		CHECK(frw_bulkEraseFlashRecv(NULL, (Uint16[4]){0, 0, eraseToken(), 0}) == CANOPEN_NO_ERR, "bulk erase refused");
+		do {
+			runFor(ERASE_POLL_US);
+			room(&flashStatus);
+		} while ((flashStatus & WIP) && (spiFlashSim_us < GIVE_UP_US));
+	}
+	CHECK(spiFlashSim_us < GIVE_UP_US, "erase never finished");
+	u.eraseUs = spiFlashSim_us;
+	u.statusReadsErasing = spiFlashSim_statusReads;
+
+	startUs = spiFlashSim_us;
+	CHECK(startDownload(1, offset) == CANOPEN_NO_ERR, "download refused");
+	for (pos = 0; (pos < len) && (spiFlashSim_us < startUs + GIVE_UP_US); pos += BLOCK){
+		while (((room(NULL) < BLOCK) || (!sectorErase && (fastRWBuffHalvesFull != 0))) && (spiFlashSim_us < startUs + GIVE_UP_US)){
+			runFor(POLL_US);
+		}
+		runFor(CAN_BLOCK_US);
+		CHECK(sendBlock(image + pos, BLOCK) == CANOPEN_NO_ERR, "block at %ld refused", pos);
+	}
+	while (!flashIdle() && (spiFlashSim_us < startUs + GIVE_UP_US)){
+		runFor(US_PER_PASS);
+	}
+	while (room(&flashStatus), flashStatus & WIP){
+		runFor(US_PER_PASS);
+	}
+	CHECK(spiFlashSim_us < startUs + GIVE_UP_US, "download never finished");
+	u.downloadUs = spiFlashSim_us - startUs;
+
+	CHECK(memcmp(spiFlashSim_mem + offset, image, len) == 0, "image not in flash");
+	for (i = 0; i < SPI_FLASH_SIM_BYTES; i++){
+		if ((i >= (long)offset) && (i < (long)offset + len)) continue;
+		if (sectorErase && ((i < (long)(offset & ~0xFFFFL)) || (i > (long)((offset + len - 1) | 0xFFFF)))) {
+			CHECK(spiFlashSim_mem[i] == (unsigned char)((i >> 8) ^ i), "byte %05lX outside the erased sectors changed", i);
+		} else {
+			CHECK(spiFlashSim_mem[i] == 0xFF, "byte %05lX not erased", i);
+		}
+		if (fails) break;
+	}
+	CHECK(spiFlashSim_pagePrograms == len / BLOCK, "%ld page programs for %ld blocks", spiFlashSim_pagePrograms, len / BLOCK);
+	CHECK(spiFlashSim_errors == 0, "%ld commands the flash ignored", spiFlashSim_errors);
+	return u;
+}
+
+static void updateTimes(void){
+	static const struct { long len; Uint32 offset; } img[] = {{0x10000L, 0x10000L}, {0x2D000L, 0x20000L}};
+	static const double tpp[] = {TPP_TYP_US, TPP_MAX_US};
+	struct UPDATE before, after;
+	double slower;
+	int k, t;
+
+	spiFlashSim_tseUs = TSE_TYP_US;
+	spiFlashSim_tbeUs = TBE_TYP_US;
+	for (k = 0; k < 2; k++){
+		for (t = 0; t < 2; t++){
+			before = update(img[k].len, img[k].offset, 0, tpp[t]);
+			after = update(img[k].len, img[k].offset, 1, tpp[t]);
+			printf("%3ld KB, tPP %.1f mSec: bulk erase, one half %5.2f Sec (download %5.2f); sector erase, both halves %5.2f Sec (download %5.2f)\n",
+				img[k].len >> 10, tpp[t] / 1000, (before.eraseUs + before.downloadUs) / 1e6, before.downloadUs / 1e6,
+				(after.eraseUs + after.downloadUs) / 1e6, after.downloadUs / 1e6);
+			CHECK(after.eraseUs + after.downloadUs < before.eraseUs + before.downloadUs, "no faster");
+			// the other half saves the PC waiting on a poll for room; it can't
+			// make the flash any faster
+			if (tpp[t] < CAN_BLOCK_US) {
+				CHECK(after.downloadUs < before.downloadUs - (img[k].len / BLOCK) * POLL_US / 2, "download no faster");
+			} else {
+				CHECK(after.downloadUs <= before.downloadUs, "download slower");
+			}
+			slower = (CAN_BLOCK_US > tpp[t]) ? CAN_BLOCK_US : tpp[t];
+			CHECK(after.downloadUs < (img[k].len / BLOCK) * (slower + PASSES_PER_BLOCK * US_PER_PASS) + CAN_BLOCK_US + POLL_US,
+				"download %.0f uSec, the slower of CAN and tPP %.0f", after.downloadUs, (img[k].len / BLOCK) * slower);
+			// WIP read every 5 mSec, give or take
+			CHECK(after.statusReadsErasing < after.eraseUs / 4000, "%ld status reads in %.0f uSec of erase",
+				after.statusReadsErasing, after.eraseUs);
+		}
+	}
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// 2. 0x204C.24
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+static void sectorMarks(const char* what, Uint16 first, Uint16 last){
+	long s, i;
+
+	for (s = 0; s < SPI_FLASH_SIM_BYTES / SPI_FLASH_SIM_SECTOR; s++){
+		for (i = s * SPI_FLASH_SIM_SECTOR; i < (s + 1) * SPI_FLASH_SIM_SECTOR; i++){
+			if ((s >= first) && (s <= last)) {
+				if (spiFlashSim_mem[i] != 0xFF) break;
+			} else if (spiFlashSim_mem[i] != (unsigned char)((i >> 8) ^ i)) {
+				break;
+			}
+		}
+		CHECK(i == (s + 1) * SPI_FLASH_SIM_SECTOR, "%s: sector %ld %s at %05lX", what, s,
+			((s >= first) && (s <= last)) ? "not erased" : "changed", i);
+	}
+}
+
+static void eraseRequests(void){
+	Uint16 token;
+
+	spiFlashSim_tppUs = TPP_TYP_US;
+	spiFlashSim_tseUs = TSE_TYP_US;
+	powerUp();
+	token = eraseToken();
+	CHECK(eraseSectors(token + 1, 0, 0) == CANOPEN_BAD_FLASH_ERASE_TOKEN, "wrong token taken");
+	CHECK(eraseSectors(token, 4, 3) == CANOPEN_FLASH_SECTOR_ERR, "sectors 4 - 3 taken");
+	CHECK(eraseSectors(token, 0, 8) == CANOPEN_FLASH_SECTOR_ERR, "sectors 0 - 8 taken");
+	CHECK(sectorsLeft() == 0, "%u sectors to erase, none asked for", sectorsLeft());
+
+	CHECK(eraseSectors(token, 3, 4) == CANOPEN_NO_ERR, "sectors 3 - 4 refused");
+	CHECK(sectorsLeft() == 2, "%u sectors to erase, 2 asked for", sectorsLeft());
+	CHECK(eraseSectors(token, 6, 6) == CANOPEN_FLASH_SECTOR_ERR, "second erase taken during the first");
+	CHECK(startDownload(1, 0x30000L) == CANOPEN_FLASH_SECTOR_ERR, "download started during the erase");
+	runFor(TSE_TYP_US * 1.5);
+	CHECK(sectorsLeft() == 1, "%u sectors to erase, half way", sectorsLeft());
+	runFor(TSE_TYP_US);
+	CHECK(sectorsLeft() == 0, "%u sectors to erase, after both", sectorsLeft());
+	CHECK(miscFlashTaskOperation == MISC_FLASH_TASK_NO_OP, "MiscFlashTasks still busy");
+	sectorMarks("sectors 3 - 4", 3, 4);
+
+	// a block still going to the flash, then the download left "ready"
+	CHECK(startDownload(1, 0x30000L) == CANOPEN_NO_ERR, "download refused");
+	sendBlock(image, BLOCK);
+	CHECK(eraseSectors(token, 6, 6) == CANOPEN_FLASH_SECTOR_ERR, "erase taken with download data waiting");
+	runFor(TPP_TYP_US * 2);
+	CHECK(flashIdle(), "block not written");
+	CHECK(mcsFileRecvStatus == FAST_FILE_READY_TO_RECEIVE, "fast download status %u", mcsFileRecvStatus);
+	CHECK(eraseSectors(token, 6, 6) == CANOPEN_NO_ERR, "erase refused after a fast download");
+	runFor(TSE_TYP_US * 1.1);
+	CHECK(sectorsLeft() == 0, "%u sectors to erase", sectorsLeft());
+
+	// an algorithm 0 download started and never finished
+	CHECK(startDownload(0, 0x30000L) == CANOPEN_NO_ERR, "algorithm 0 refused");
+	CHECK(mcsFileRecvStatus == MCS_FILE_READY_TO_RECEIVE, "algorithm 0 status %u", mcsFileRecvStatus);
+	CHECK(eraseSectors(token, 7, 7) == CANOPEN_NO_ERR, "erase refused after an abandoned algorithm 0 download");
+	runFor(TSE_TYP_US * 1.1);
+	CHECK(sectorsLeft() == 0, "%u sectors to erase", sectorsLeft());
+	CHECK(spiFlashSim_sectorErases == 4, "%ld sector erases, 4 asked for", spiFlashSim_sectorErases);
+	CHECK(spiFlashSim_errors == 0, "%ld commands the flash ignored", spiFlashSim_errors);
+	printf("0x204C.24: token and range checked, busy refused, taken after a fast or abandoned download\n");
+}
+
+int main(void){
+	srand(16);
+	updateTimes();
+	eraseRequests();
+	printf(fails ? "FAIL (%d)\n" : "PASS\n", fails);
+	return fails != 0;
+}
@@ -0,0 +1,473 @@
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+//
+//     FpgaLoad.c
+//
+// Host test for loading the FPGAs from FLASH at startup: frw_SpiFlashTask()
+// in FlashRW.C, with frw_fpgaPrepStart() / frw_fpgaPrepStep() taking FPGA 1
+// through its PROG / INIT_B sequence, and FPGA 2 through its own while
+// FPGA 1's bitstream goes out.  The FPGAs are FpgaSim.c, the FLASH and
+// SPI are here: spi_ReadFlash() and spi_ClockFlashToFpga() put every byte
+// they read on the data line all the FPGAs share, at the FAST_READ rate.
+// The task runs back to back with other tasks taking fpgaSim_... between
+// passes.
+//  1. both FPGAs load, each from its own bitstream.  Each FPGA's lines
+//     go through PROG LOW, INIT_B LOW, PROG HI, INIT_B HI, and only then
+//     its sync word; FPGA 2 is not released before FPGA 1's sync word
+//     has gone by, so it never takes FPGA 1's bitstream.  FPGA 2's
+//     sequence runs under FPGA 1's bitstream: it goes to data without
+//     waiting on INIT_B, where FPGA 1 waited the full clear time, and the
+//     load is that much shorter than doing the sequences one after the
+//     other (the code before frw_fpgaPrepStart()).  No task pass takes
+//     longer than a block of bitstream.  For clear times from 0.3 to 8
+//     mSec, and 0 - 200 uSec of other tasks between passes.
+//  2. FPGA 2 picks up stray data after its sequence (INIT_B LOW, CRC
+//     error), right after INIT_B goes HI or well after the task has seen
+//     it HI: the sequence is run again for it, and it loads
+//  3. an FPGA whose INIT_B never goes LOW, or never comes back HI: the
+//     load stops with the LED error for it, 50 mSec after its PROG pulse
+//     (or release); the first FPGA is still loaded if the second one fails
+//  4. the bitstream checksum in the FLASH header, and the "verified image"
+//     record at 0xF0.  1. - 3. are boots with the record in place.  On the
+//     first boot of new images each bitstream is read through and checked
+//     with the FPGAs held in PROG (none of them takes any of it), then
+//     loaded, and its record written; the next boot reads each bitstream
+//     once and writes nothing.  A corrupt byte anywhere in a new image
+//     stops the load with the checksum LED error before that FPGA is
+//     loaded, and no record is written for it.  A corrupt byte in an image
+//     that has a record is loaded, then caught by the sum taken while
+//     clocking it in: the FPGA is cleared again with PROG.  Data in the
+//     record space that is not a record for this header (another image's,
+//     one with another length, or anything else) is left alone, and the
+//     image is checked every boot.
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "DSP281x_Device.h"
+#include "stdbool.h"
+#include "CanOpen.H"
+#include "FlashRW.H"
+#include "GpioUtil.h"
+#include "LED.h"
+#include "SPI.H"
+#include "Timer0.h"
+#include "FpgaSim.h"
+
+// FlashRW.C internals
+extern enum LOAD_FPGA_FROM_FLASH_STATE frwFlashTaskState;
+
+#define FPGAS 2					// MAX_FPGAS_TO_LOAD in FlashRW.C
+#define FLASH_BYTES 0x10000L
+#define BITSTREAM_AT 0x100
+#define BLOCK_BYTES 4096		// BITSTREAM_BLOCKSIZE in FlashRW.C
+#define PAYLOAD_BYTES 40000
+
+static int fails;
+#define CHECK(c, ...) do { if (!(c)) { printf("FAIL %s:%d ", __FILE__, __LINE__); \
+	printf(__VA_ARGS__); printf("\n"); fails++; if (fails > 10) exit(1); } } while (0)
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// the FLASH chips, and the rest of the firmware FlashRW.C calls
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+static unsigned char flash[FPGAS + 1][FLASH_BYTES];
+static Uint32 readAddr;
+static int writeEnabled;
+static int busyPolls;			// status reads left showing WIP
+static int pagePrograms[FPGAS + 1];
+static int bitstreamReads[FPGAS + 1];	// spi_ClockFlashToFpgaStart()s at the bitstream
+static enum LED_ERROR_NUMBER ledError;
+
+Uint32 timer0_fetchSystemMiliSecCount(void){
+	return (Uint32)(fpgaSim_us / 1000);
+}
+
+void led_dspLedErrMsg(enum LED_ERROR_NUMBER count){
+	ledError = count;
+}
+
+void led_setDspLedPattern(enum LED_PATTERN pattern){
+	(void)pattern;
+}
+
+void spi_disableAllSpiDevices(void){
+}
+
+static Uint16 flashWord(void){
+	Uint16 hi, lo;
+
+	hi = flash[frw_GetWhichFlash()][readAddr++ % FLASH_BYTES];
+	lo = flash[frw_GetWhichFlash()][readAddr++ % FLASH_BYTES];
+	fpgaSim_clockByte(hi);
+	fpgaSim_clockByte(lo);
+	return (hi << 8) | lo;
+}
+
+bool spi_ReadFlash(Uint16* address, Uint16 countWordsToRead, Uint16* destBuff){
+	spi_ClockFlashToFpgaStart(address);
+	while (countWordsToRead-- > 0){
+		*(destBuff++) = flashWord();
+	}
+	return true;
+}
+
+void spi_ClockFlashToFpgaStart(Uint16* address){
+	readAddr = ((Uint32)(address[1] & 0x00FF) << 16) | address[0];
+	if (readAddr == BITSTREAM_AT) bitstreamReads[frw_GetWhichFlash()]++;
+	fpgaSim_us += 5 * fpgaSim_usPerByte;	// instruction, address, dummy byte
+}
+
+Uint16 spi_ClockFlashToFpga(Uint16 countWordsToRead){
+	Uint16 sum = 0;
+
+	while (countWordsToRead-- > 0){
+		sum += flashWord();
+	}
+	return sum;
+}
+
+void spi_SetFlashWriteEnable(void){
+	writeEnabled = 1;
+}
+
+Uint16 spi_ReadSpiFlashStatus(void){
+	fpgaSim_us += 2 * fpgaSim_usPerByte;
+	if (busyPolls > 0) {
+		busyPolls--;
+		return 0x01;	// WIP
+	}
+	return 0;
+}
+
+// a page program: bits go 1 -> 0 only, and it is not on the FPGA data line
+bool spi_WriteFlash(Uint16* address, Uint16 countWordsToWrite, Uint16* sourceBuff){
+	int n = frw_GetWhichFlash();
+	Uint32 a = ((Uint32)(address[1] & 0x00FF) << 16) | address[0];
+
+	CHECK(writeEnabled, "FLASH %d written without a write enable", n);
+	writeEnabled = 0;
+	while (countWordsToWrite-- > 0){
+		flash[n][a++ % FLASH_BYTES] &= *sourceBuff >> 8;
+		flash[n][a++ % FLASH_BYTES] &= *(sourceBuff++) & 0x00FF;
+	}
+	pagePrograms[n]++;
+	busyPolls = 20;
+	fpgaSim_us += 4 + 2 * fpgaSim_usPerByte;
+	return true;
+}
+
+#define IMAGE_BYTES (4 + 4 + 4 + PAYLOAD_BYTES)
+#define RECORD_AT 0xF0
+
+// the "verified image" record FlashRW.C writes for the header in FLASH n:
+// 5AFE, header bytes 8 - 11 (hash, A5, checksum), the length
+static void makeRecord(int n, unsigned char* rec){
+	rec[0] = 0x5A; rec[1] = 0xFE;
+	memcpy(rec + 2, flash[n] + 8, 4);
+	memcpy(rec + 6, flash[n] + 4, 4);
+}
+
+static int hasRecord(int n){
+	unsigned char rec[10];
+
+	makeRecord(n, rec);
+	return memcmp(flash[n] + RECORD_AT, rec, sizeof rec) == 0;
+}
+
+// header, then FF padding, the sync word, the FPGA number, the byte count,
+// and that many bytes; the header checksum is the sum of the 16-bit words
+// of all that; and the verified image record if asked for
+static void makeFlash(int n, int verified){
+	unsigned char* p = flash[n];
+	Uint32 length = IMAGE_BYTES;
+	Uint32 i;
+	Uint16 hash = 0;
+	Uint16 sum = 0;
+
+	memset(p, 0xFF, FLASH_BYTES);
+	p[0] = 0; p[1] = 0; p[2] = BITSTREAM_AT >> 8; p[3] = BITSTREAM_AT & 0xFF;
+	p[4] = length >> 24; p[5] = length >> 16; p[6] = length >> 8; p[7] = length;
+	for (i = 0; i < 8; i++){
+		hash ^= p[i];
+	}
+	p[8] = hash;
+	p[9] = 0xA5;
+	p += BITSTREAM_AT;
+	p += 4;
+	*p++ = 0xAA; *p++ = 0x99; *p++ = 0x55; *p++ = 0x66;
+	*p++ = 0; *p++ = n;
+	*p++ = PAYLOAD_BYTES >> 8; *p++ = PAYLOAD_BYTES & 0xFF;
+	for (i = 0; i < PAYLOAD_BYTES; i++){
+		*p++ = rand();
+	}
+	p = flash[n];
+	for (i = 0; i < length; i += 2){
+		sum += (p[BITSTREAM_AT + i] << 8) | p[BITSTREAM_AT + i + 1];
+	}
+	p[10] = sum >> 8;
+	p[11] = sum & 0xFF;
+	if (verified) makeRecord(n, p + RECORD_AT);
+}
+
+static void makeFlashes(int verified){
+	int n;
+
+	for (n = 1; n <= FPGAS; n++){
+		makeFlash(n, verified);
+	}
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// a load at startup
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+struct LOAD {
+	double waitInit[FPGAS + 1];		// uSec from LOAD_FPGA_PROG_AND_INIT to data
+	double firstData[FPGAS + 1];	// its first block of bitstream
+	double longestPass;
+	double errorAt;					// went to LOAD_FPGA_ERROR_CLEANUP
+	double us;
+};
+
+// power-up, with the FLASH as it is
+static void startUp(void){
+	GpioMuxRegs.GPFDIR.all = 0;
+	frw_initFpgaLoadPins();
+	fpgaSim_reset();
+	memset(pagePrograms, 0, sizeof pagePrograms);
+	memset(bitstreamReads, 0, sizeof bitstreamReads);
+	writeEnabled = 0;
+	busyPolls = 0;
+	ledError = 0;
+	frw_SetWhichFlash(1);
+	frw_SpiFlashInit();
+}
+
+static struct LOAD load(double betweenPasses){
+	struct LOAD r;
+	enum LOAD_FPGA_FROM_FLASH_STATE was;
+	double t, waitFrom = 0;
+	Uint16 fpga;
+
+	memset(&r, 0, sizeof r);
+	while ((frwFlashTaskState != LOAD_FPGA_NO_OP) && (fpgaSim_us < 1e6)){
+		t = fpgaSim_us;
+		was = frwFlashTaskState;
+		fpga = frw_GetWhichFlash();
+		frw_SpiFlashTask();
+		if (fpgaSim_us - t > r.longestPass) r.longestPass = fpgaSim_us - t;
+		if ((was != LOAD_FPGA_WAIT_INIT) && (frwFlashTaskState == LOAD_FPGA_WAIT_INIT)) {
+			waitFrom = fpgaSim_us;
+		} else if ((was == LOAD_FPGA_WAIT_INIT) && (frwFlashTaskState != LOAD_FPGA_WAIT_INIT)) {
+			r.waitInit[fpga] += fpgaSim_us - waitFrom;
+		}
+		if (frwFlashTaskState == LOAD_FPGA_ERROR_CLEANUP) {
+			r.errorAt = fpgaSim_us;
+		}
+		if ((was == LOAD_FPGA_CLOCK_DATA_IN) && (r.firstData[fpga] == 0)) {
+			r.firstData[fpga] = t;
+		}
+		fpgaSim_us += betweenPasses * (rand() % 101) / 100.0;
+	}
+	r.us = fpgaSim_us;
+	return r;
+}
+
+// each FPGA's lines went PROG LOW, INIT_B LOW, PROG HI, INIT_B HI, sync word,
+// with its own bitstream
+static void loadedInOrder(const struct LOAD* r, const char* what){
+	int n;
+
+	for (n = 1; n <= FPGAS; n++){
+		CHECK(fpgaSim_done(n) && (fpgaSim[n].configuredAs == n), "%s: FPGA %d not loaded", what, n);
+		CHECK(fpgaSim[n].shortPulses == 0, "%s: FPGA %d PROG pulse under tPROGRAM", what, n);
+		CHECK(fpgaSim[n].earlyRelease == 0, "%s: FPGA %d PROG released before INIT_B went LOW", what, n);
+		CHECK(fpgaSim[n].syncs == 1, "%s: FPGA %d took %d sync words after its PROG pulse", what, n, fpgaSim[n].syncs);
+		CHECK(fpgaSim[n].initHiAt <= r->firstData[n], "%s: FPGA %d bitstream started %.0f uSec before INIT_B HI",
+			what, n, fpgaSim[n].initHiAt - r->firstData[n]);
+	}
+	CHECK(frw_GetLoadFpgasAtStartupStatus() == F_LOAD_COMPLETE, "%s: status %d", what, frw_GetLoadFpgasAtStartupStatus());
+	CHECK(ledError == 0, "%s: LED error %d", what, ledError);
+}
+
+// 1.
+static void bothLoad(void){
+	static const double clearUs[] = {300, 1000, 3000, 8000};
+	static const double betweenPasses[] = {0, 50, 200};
+	double blockUs = BLOCK_BYTES * fpgaSim_usPerByte;
+	double serial;
+	char what[60];
+	struct LOAD r;
+	unsigned c, b;
+
+	for (c = 0; c < sizeof clearUs / sizeof clearUs[0]; c++){
+		for (b = 0; b < sizeof betweenPasses / sizeof betweenPasses[0]; b++){
+			makeFlashes(1);
+			startUp();
+			fpgaSim_clearUs = clearUs[c];
+			sprintf(what, "clear %.0f uSec, %.0f uSec between passes", clearUs[c], betweenPasses[b]);
+			r = load(betweenPasses[b]);
+			loadedInOrder(&r, what);
+			CHECK(fpgaSim[2].progPulses == 1, "%s: FPGA 2 PROG pulsed %d times", what, fpgaSim[2].progPulses);
+			CHECK(r.waitInit[1] >= clearUs[c], "%s: FPGA 1 waited %.0f uSec on INIT_B", what, r.waitInit[1]);
+			CHECK(r.waitInit[2] < betweenPasses[b] + 50, "%s: FPGA 2 waited %.0f uSec on INIT_B", what, r.waitInit[2]);
+			CHECK(r.longestPass < blockUs + 50, "%s: a pass took %.0f uSec", what, r.longestPass);
+			serial = r.us + fpgaSim_initLowUs + clearUs[c];
+			if (betweenPasses[b] == 50) {
+				printf("clear %4.0f uSec: FPGA 1 waited %5.0f uSec on INIT_B, FPGA 2 %2.0f; loaded in %.2f mSec, %.2f one after the other\n",
+					clearUs[c], r.waitInit[1], r.waitInit[2], r.us / 1000, serial / 1000);
+			}
+		}
+	}
+}
+
+// 2.
+static void strayData(int afterBytes){
+	struct LOAD r;
+	char what[40];
+
+	makeFlashes(1);
+	startUp();
+	fpgaSim[2].strayLock = afterBytes;
+	sprintf(what, "stray data %d bytes on", afterBytes);
+	r = load(50);
+	loadedInOrder(&r, what);
+	CHECK(fpgaSim[2].crcErrors == 1, "%s: %d CRC errors", what, fpgaSim[2].crcErrors);
+	CHECK(fpgaSim[2].progPulses == 2, "%s: FPGA 2 PROG pulsed %d times", what, fpgaSim[2].progPulses);
+	CHECK(r.waitInit[2] >= fpgaSim_clearUs, "%s: FPGA 2 waited %.0f uSec on INIT_B", what, r.waitInit[2]);
+}
+
+// 3.
+static void stuck(int n, int neverLow, enum LED_ERROR_NUMBER want){
+	struct LOAD r;
+	char what[40];
+
+	makeFlashes(1);
+	startUp();
+	fpgaSim[n].neverInitLow = neverLow;
+	fpgaSim[n].neverInitHi = !neverLow;
+	sprintf(what, "FPGA %d INIT_B never %s", n, neverLow ? "LOW" : "HI");
+	r = load(50);
+	CHECK(frw_GetLoadFpgasAtStartupStatus() == F_LOAD_ERROR, "%s: status %d", what, frw_GetLoadFpgasAtStartupStatus());
+	CHECK(ledError == want, "%s: LED error %d", what, ledError);
+	CHECK((r.errorAt - fpgaSim[n].progLowAt >= 50000) && (r.errorAt - fpgaSim[n].progLowAt < 54000),
+		"%s: gave up %.0f uSec after the PROG pulse", what, r.errorAt - fpgaSim[n].progLowAt);
+	CHECK(r.longestPass < BLOCK_BYTES * fpgaSim_usPerByte + 50, "%s: a pass took %.0f uSec", what, r.longestPass);
+	if (n == 2) {
+		CHECK(fpgaSim_done(1) && (fpgaSim[1].configuredAs == 1), "%s: FPGA 1 not loaded", what);
+	}
+}
+
+// 4.
+static void firstBoot(void){
+	struct LOAD first, next;
+	int n;
+
+	makeFlashes(0);
+	startUp();
+	first = load(50);
+	loadedInOrder(&first, "first boot");
+	for (n = 1; n <= FPGAS; n++){
+		CHECK(fpgaSim[n].allSyncs == 1, "first boot: FPGA %d took %d sync words", n, fpgaSim[n].allSyncs);
+		CHECK(fpgaSim[n].crcErrors == 0, "first boot: FPGA %d CRC error", n);
+		CHECK(bitstreamReads[n] == 2, "first boot: bitstream %d read %d times", n, bitstreamReads[n]);
+		CHECK(hasRecord(n), "first boot: no verified image record in FLASH %d", n);
+		CHECK(pagePrograms[n] == 1, "first boot: %d page programs in FLASH %d", pagePrograms[n], n);
+	}
+
+	startUp();
+	next = load(50);
+	loadedInOrder(&next, "next boot");
+	for (n = 1; n <= FPGAS; n++){
+		CHECK(bitstreamReads[n] == 1, "next boot: bitstream %d read %d times", n, bitstreamReads[n]);
+		CHECK(hasRecord(n), "next boot: verified image record in FLASH %d gone", n);
+		CHECK(pagePrograms[n] == 0, "next boot: FLASH %d written", n);
+	}
+	printf("new images: loaded in %.2f mSec, %.2f on the boots after\n", first.us / 1000, next.us / 1000);
+}
+
+static void corrupt(int n, int verified){
+	Uint32 at;
+	int i;
+	char what[60];
+
+	for (i = 0; i < 8; i++){
+		if (verified) {
+			at = 12 + (Uint32)rand() % (PAYLOAD_BYTES - 1);	// past the FPGA's header
+		} else {
+			at = (i == 0) ? 0 : (i == 1) ? IMAGE_BYTES - 1 : (Uint32)rand() % IMAGE_BYTES;
+		}
+		makeFlashes(verified);
+		flash[n][BITSTREAM_AT + at] ^= 1 << (rand() % 8);
+		sprintf(what, "%s image %d, byte %lu corrupt", verified ? "verified" : "new", n, (unsigned long)at);
+		startUp();
+		load(50);
+		CHECK(frw_GetLoadFpgasAtStartupStatus() == F_LOAD_ERROR, "%s: status %d", what, frw_GetLoadFpgasAtStartupStatus());
+		CHECK(ledError == LED_ERROR_BITSTREAM_CHECKSUM, "%s: LED error %d", what, ledError);
+		CHECK(!fpgaSim_done(n), "%s: FPGA %d left configured", what, n);
+		CHECK(bitstreamReads[n] == 1, "%s: read %d times", what, bitstreamReads[n]);
+		CHECK(pagePrograms[n] == 0, "%s: FLASH %d written", what, n);
+		if (verified) {
+			CHECK(fpgaSim[n].doneAt > 0, "%s: never loaded", what);
+			CHECK(hasRecord(n), "%s: record gone", what);
+		} else {
+			CHECK(fpgaSim[n].allSyncs == 0, "%s: loaded anyway", what);
+		}
+		if (n == 2) {
+			CHECK(fpgaSim_done(1) && (fpgaSim[1].configuredAs == 1), "%s: FPGA 1 not loaded", what);
+		}
+	}
+}
+
+enum NOT_MY_RECORD { OTHER_DATA, OTHER_IMAGE, OTHER_LENGTH };
+
+static void notMyRecord(enum NOT_MY_RECORD kind){
+	static const char* const whats[] = {"data in the record space", "another image's record", "a record with another length"};
+	const char* what = whats[kind];
+	unsigned char was[10];
+	int boot;
+
+	if (kind == OTHER_DATA) {
+		makeFlashes(0);
+		flash[2][RECORD_AT + 3] = 0x00;
+	} else if (kind == OTHER_IMAGE) {
+		makeFlashes(1);
+		memcpy(was, flash[2] + RECORD_AT, sizeof was);
+		makeFlash(2, 0);
+		memcpy(flash[2] + RECORD_AT, was, sizeof was);
+	} else {
+		makeFlashes(1);
+		flash[2][RECORD_AT + 9] ^= 0x04;
+	}
+	memcpy(was, flash[2] + RECORD_AT, sizeof was);
+	for (boot = 0; boot < 2; boot++){
+		startUp();
+		load(50);
+		CHECK(fpgaSim_done(2) && (fpgaSim[2].configuredAs == 2), "%s: FPGA 2 not loaded", what);
+		CHECK(bitstreamReads[2] == 2, "%s: read %d times", what, bitstreamReads[2]);
+		CHECK(pagePrograms[2] == 0, "%s: FLASH 2 written", what);
+		CHECK(memcmp(flash[2] + RECORD_AT, was, sizeof was) == 0, "%s: changed", what);
+		CHECK(hasRecord(1), "%s: no record for FLASH 1", what);
+	}
+}
+
+int main(void){
+	srand(13);
+	bothLoad();
+	strayData(1);
+	strayData(10000);
+	stuck(1, 1, LED_ERROR_BAD_INIT_B_NOT_LOW);
+	stuck(1, 0, LED_ERROR_BAD_INIT_B_NOT_HI);
+	stuck(2, 1, LED_ERROR_BAD_INIT_B_NOT_LOW);
+	stuck(2, 0, LED_ERROR_BAD_INIT_B_NOT_HI);
+	firstBoot();
+	corrupt(1, 0);
+	corrupt(2, 0);
+	corrupt(1, 1);
+	corrupt(2, 1);
+	notMyRecord(OTHER_DATA);
+	notMyRecord(OTHER_IMAGE);
+	notMyRecord(OTHER_LENGTH);
+	printf(fails ? "FAIL (%d)\n" : "PASS\n", fails);
+	return fails != 0;
+}
@@ -0,0 +1,212 @@
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+//
+//     FpgaSim.c
+//
+// See FpgaSim.h.
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+#include <string.h>
+
+#include "DSP281x_Device.h"
+#include "FpgaSim.h"
+
+#undef GpioDataRegs
+#undef GpioMuxRegs
+
+#define T_PROGRAM 0.3			// uSec, shortest PROG pulse
+#define SYNC_WORD 0xAA995566L
+#define NEVER     1e300
+
+struct FPGA_SIM fpgaSim[FPGA_SIM_COUNT + 1];
+double fpgaSim_us;
+double fpgaSim_usPerAccess = 0.05;
+double fpgaSim_usPerByte = 8 / 18.75;	// FAST_READ at 18.75MHz
+double fpgaSim_initLowUs = 20;
+double fpgaSim_clearUs = 1000;
+
+static volatile struct GPIO_DATA_REGS regs;
+static volatile struct GPIO_MUX_REGS mux;
+static double lastAccessUs;		// when the GPIO write applyWrite() applies was made
+static Uint16 latchF;			// GPIOF output latch
+
+enum FPGA_STATE { F_PROG_LOW, F_CLEARING, F_HUNT, F_HEADER, F_DATA, F_DONE, F_CRC_ERROR };
+static struct {
+	enum FPGA_STATE state;
+	int prog;
+	double initLowAt;
+	double clearEnd;
+	int cleared;			// by a PROG pulse, not since power-up
+	Uint32 window;			// the last 4 bytes seen, while hunting for the sync word
+	int headerBytes;
+	Uint16 number;			// FPGA number in the bitstream header
+	Uint16 count;			// bytes of it to come
+} f[FPGA_SIM_COUNT + 1];
+
+static int progLine(int n){
+	Uint16 bit = 0x0080 << n;
+
+	return !(mux.GPFDIR.all & bit) || (latchF & bit);
+}
+
+static int initB(int n){
+	switch (f[n].state){
+	case F_PROG_LOW:
+		return fpgaSim_us < f[n].initLowAt;
+	case F_CLEARING:
+		return fpgaSim[n].neverInitLow;
+	case F_CRC_ERROR:
+		return 0;
+	default:
+		return 1;
+	}
+}
+
+// FPGA n at time us
+static void update(int n, double us){
+	int prog = progLine(n);
+
+	if (!prog && f[n].prog) {
+		fpgaSim[n].progPulses++;
+		fpgaSim[n].progLowAt = us;
+		fpgaSim[n].syncs = 0;
+		fpgaSim[n].configuredAs = 0;
+		f[n].state = F_PROG_LOW;
+		f[n].initLowAt = fpgaSim[n].neverInitLow ? NEVER : us + fpgaSim_initLowUs;
+	} else if (prog && !f[n].prog && (f[n].state == F_PROG_LOW)) {
+		if (us - fpgaSim[n].progLowAt < T_PROGRAM) fpgaSim[n].shortPulses++;
+		if (us < f[n].initLowAt) fpgaSim[n].earlyRelease++;
+		f[n].state = F_CLEARING;
+		f[n].clearEnd = fpgaSim[n].neverInitHi ? NEVER : us + fpgaSim_clearUs;
+	}
+	f[n].prog = prog;
+	if ((f[n].state == F_CLEARING) && (us >= f[n].clearEnd)) {
+		f[n].state = F_HUNT;
+		f[n].cleared = 1;
+		f[n].window = 0;
+		fpgaSim[n].initHiAt = f[n].clearEnd;
+	}
+}
+
+void fpgaSim_reset(void){
+	int n;
+
+	memset(fpgaSim, 0, sizeof fpgaSim);
+	fpgaSim_us = 0;
+	lastAccessUs = 0;
+	for (n = 1; n <= FPGA_SIM_COUNT; n++){
+		f[n].state = F_HUNT;
+		f[n].cleared = 0;
+		f[n].window = 0;
+		f[n].prog = progLine(n);
+	}
+}
+
+// the GPFSET / GPFCLEAR write made at the last access, if any, as of then
+static void applyWrite(void){
+	int n;
+
+	if ((regs.GPFSET.all == 0) && (regs.GPFCLEAR.all == 0)) return;
+	latchF = (latchF | regs.GPFSET.all) & ~regs.GPFCLEAR.all;
+	regs.GPFSET.all = 0;
+	regs.GPFCLEAR.all = 0;
+	for (n = 1; n <= FPGA_SIM_COUNT; n++){
+		update(n, lastAccessUs);
+	}
+}
+
+void fpgaSim_clockByte(Uint16 byte){
+	int n;
+
+	applyWrite();
+	byte &= 0x00FF;
+	for (n = 1; n <= FPGA_SIM_COUNT; n++){
+		update(n, fpgaSim_us);
+		switch (f[n].state){
+		case F_HUNT:
+			if ((fpgaSim[n].strayLock > 0) && f[n].cleared && (--fpgaSim[n].strayLock == 0)) {
+				fpgaSim[n].crcErrors++;
+				f[n].state = F_CRC_ERROR;
+				break;
+			}
+			f[n].window = (f[n].window << 8) | byte;
+			if (f[n].window == SYNC_WORD) {
+				fpgaSim[n].syncs++;
+			fpgaSim[n].allSyncs++;
+				f[n].state = F_HEADER;
+				f[n].headerBytes = 0;
+			}
+			break;
+		case F_HEADER:
+			if (f[n].headerBytes < 2) {
+				f[n].number = (f[n].number << 8) | byte;
+			} else {
+				f[n].count = (f[n].count << 8) | byte;
+			}
+			if (++f[n].headerBytes == 4) {
+				f[n].state = F_DATA;
+			}
+			break;
+		case F_DATA:
+			if (--f[n].count == 0) {
+				if (f[n].number == n) {
+					f[n].state = F_DONE;
+					fpgaSim[n].configuredAs = n;
+					fpgaSim[n].doneAt = fpgaSim_us;
+				} else {
+					f[n].state = F_CRC_ERROR;
+					fpgaSim[n].crcErrors++;
+				}
+			}
+			break;
+		default:
+			break;
+		}
+	}
+	fpgaSim_us += fpgaSim_usPerByte;
+}
+
+int fpgaSim_initB(int n){
+	applyWrite();
+	update(n, fpgaSim_us);
+	return initB(n);
+}
+
+int fpgaSim_done(int n){
+	applyWrite();
+	update(n, fpgaSim_us);
+	return f[n].state == F_DONE;
+}
+
+// apply the write made at the last access, and run the FPGAs up to now
+static void sync(void){
+	int n;
+
+	applyWrite();
+	regs.GPBDAT.all = 0;
+	regs.GPADAT.all = 0;
+	for (n = 1; n <= FPGA_SIM_COUNT; n++){
+		update(n, fpgaSim_us);
+		if (initB(n)) regs.GPBDAT.all |= 0x0800 << n;
+		if (f[n].state == F_DONE) regs.GPADAT.all |= 0x0001 << (n - 1);
+	}
+	regs.GPFDAT.all = latchF;
+}
+
+volatile struct GPIO_DATA_REGS* fpgaSim_gpioData(void){
+	sync();
+	lastAccessUs = fpgaSim_us;
+	fpgaSim_us += fpgaSim_usPerAccess;
+	return &regs;
+}
+
+// the FPGAs run up to now with the PROG lines as they were, before the
+// direction change that may follow
+volatile struct GPIO_MUX_REGS* fpgaSim_gpioMux(void){
+	int n;
+
+	applyWrite();
+	for (n = 1; n <= FPGA_SIM_COUNT; n++){
+		update(n, fpgaSim_us);
+	}
+	return &mux;
+}
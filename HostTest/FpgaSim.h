@@ -0,0 +1,76 @@
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+//
+//     FpgaSim.h
+//
+// The FPGAs FlashRW.C loads, on their TB3CMB (TB3CMB_GPIO) control lines,
+// as the host tests need them.  FPGA n (1 - 3):
+//     PROG    GPIOF7+n   DSP output, pulled up HI while it is an input
+//     INIT_B  GPIOB11+n  FPGA output
+//     DONE    GPIOA(n-1) FPGA output
+// A test built with
+//     -DGpioDataRegs=(*fpgaSim_gpioData()) -DGpioMuxRegs=(*fpgaSim_gpioMux())
+// sends every GpioDataRegs access through fpgaSim_gpioData(), which first
+// applies the GPFSET / GPFCLEAR write before it to the PROG lines, runs the
+// FPGAs up to now, and puts INIT_B and DONE in GPBDAT and GPADAT for the
+// read that may follow.  A byte on the bus, a look at the lines from the
+// test, or a GpioMuxRegs access (fpgaSim_gpioMux(), PROG driven or let go)
+// applies that write too.  Each FPGA, as a Xilinx part in slave serial mode:
+//  - PROG LOW: configuration is reset, INIT_B goes LOW fpgaSim_initLowUs
+//    later; a PROG pulse shorter than 0.3 uSec (tPROGRAM) is an error
+//  - PROG back HI: the configuration memory clears, INIT_B goes HI
+//    fpgaSim_clearUs later
+//  - with INIT_B and PROG HI it watches every byte on the shared SPI data
+//    line (fpgaSim_clockByte()) for the sync word AA 99 55 66, then takes
+//    a 16-bit FPGA number, a 16-bit byte count and that many bytes; DONE
+//    goes HI if the number is its own, and INIT_B LOW (CRC error) if not
+// Power-up state: configuration memory clear, INIT_B HI, watching the bus.
+// Time: fpgaSim_us; a GPIO access takes fpgaSim_usPerAccess and a byte on
+// the bus fpgaSim_usPerByte, the test advances it for time spent elsewhere.
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+#ifndef FPGASIM_H
+#define FPGASIM_H
+
+#define FPGA_SIM_COUNT 3
+
+struct FPGA_SIM {
+	// set by the test
+	int neverInitLow;		// INIT_B does not follow PROG LOW
+	int neverInitHi;		// the configuration memory never finishes clearing
+	int strayLock;			// the next time a PROG pulse leaves it ready, it takes
+							// the strayLock'th byte on the bus after that for the
+							// end of a sync word and fails its CRC check (once)
+	// results
+	int progPulses;			// HI -> LOW transitions of PROG
+	int shortPulses;		// PROG pulses shorter than tPROGRAM
+	int earlyRelease;		// PROG released before INIT_B went LOW
+	int syncs;				// sync words taken since the last PROG pulse
+	int allSyncs;			// and since fpgaSim_reset()
+	int crcErrors;
+	int configuredAs;		// FPGA number of the bitstream DONE went HI on, 0 = none
+	double progLowAt;		// last PROG HI -> LOW
+	double initHiAt;		// last INIT_B LOW -> HI
+	double doneAt;
+};
+extern struct FPGA_SIM fpgaSim[FPGA_SIM_COUNT + 1];	// [1] - [3]
+
+extern double fpgaSim_us;
+extern double fpgaSim_usPerAccess;
+extern double fpgaSim_usPerByte;
+extern double fpgaSim_initLowUs;
+extern double fpgaSim_clearUs;
+
+// every FPGA at power-up, results zeroed, time 0; the PROG lines stay as
+// the DSP drives them
+void fpgaSim_reset(void);
+
+// a byte on the SPI data line, seen by every FPGA
+void fpgaSim_clockByte(Uint16 byte);
+
+int fpgaSim_initB(int n);
+int fpgaSim_done(int n);
+
+volatile struct GPIO_DATA_REGS* fpgaSim_gpioData(void);
+volatile struct GPIO_MUX_REGS* fpgaSim_gpioMux(void);
+
+#endif
@@ -0,0 +1,396 @@
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+//
+//     FwStubs.c
+//
+// Stand-ins for the firmware functions and data the modules linked into a
+// test use from modules that test does not link, grouped by the header
+// that declares them.  They are weak, so a linked module or the test
+// itself replaces any of them with the real thing.  A stand-in function
+// that gets called ends the test with a FAIL; stand-in data is zeroed
+// memory of the declared type.  STUB_CAN is a stand-in for a CAN_COMMAND
+// send or receive function, which all have the same parameters.
+// When a firmware change makes a test's link fail with an undefined
+// reference, add the name here.
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "DSP281x_Device.h"
+#include "stdbool.h"
+#include "CanOpen.h"
+#include "ADC.H"
+#include "AnlgIn.H"
+#include "CanComm.H"
+#include "CanFile.H"
+#include "Comint.h"
+#include "DigIO.H"
+#include "DigIO2.h"
+#include "F1Int.H"
+#include "F2Int.H"
+#include "FlashRW.H"
+#include "FpgaTest.H"
+#include "GpioUtil.h"
+#include "I2CEE.h"
+#include "LED.h"
+#include "LimitChk.H"
+#include "Log.H"
+#include "Main.H"
+#include "Resolver.H"
+#include "RS232.h"
+#include "Rs232Out.h"
+#include "SCI2.H"
+#include "SPI.H"
+#include "SSEnc.H"
+#include "Timer0.h"
+#include "TimeStamp.h"
+
+static void __attribute__((noreturn)) fwStubCalled(const char* name){
+	printf("FAIL: %s() called, it is only a stand-in here (FwStubs.c)\n", name);
+	exit(2);
+}
+
+#define STUB(type, name, params) \
+	__attribute__((weak)) type name params { fwStubCalled(#name); }
+#define STUB_CAN(name) \
+	STUB(enum CANOPEN_STATUS, name, (const struct CAN_COMMAND* can_command, Uint16* data))
+#define STUB_DATA(type, name) \
+	__attribute__((weak)) type name;
+
+// DSP281x_GlobalPrototypes.h
+STUB(void, InitECan, (void))
+STUB(void, InitPieCtrl, (void))
+STUB(void, InitPieVectTable, (void))
+STUB(void, InitSysCtrl, (void))
+STUB(void, DSP28x_usDelay, (Uint32 Count))
+
+// ADC.H
+STUB(void, adc_DisplayAdcResults, (void))
+
+// AnlgIn.H
+STUB_DATA(union CANOPEN16_32, ain_ad7175_single_write_data)
+STUB_DATA(Uint16, ain_offsets[8])
+STUB_CAN(ain_ad7175_fetch_data_read)
+STUB_CAN(ain_ad7175_fetch_status)
+STUB_CAN(ain_ad7175_request)
+STUB(void, ain_ad7175_setup_task, (void))
+STUB_CAN(ain_calibratedClassicValRaw)
+STUB_CAN(ain_calibratedClassicValue)
+STUB_CAN(ain_calibratedValue)
+STUB(void, ain_offsetCalcTask, (void))
+STUB_CAN(ain_startOffsetCalc)
+
+// CanComm.H
+STUB(void, canC_BgTask_recv, (void))
+STUB(void, canC_pdoSetCobId, (Uint16 pdoNum, Uint16 cobId))
+STUB(bool, canC_pdoTransmit, (Uint16 pdoNum, Uint16 *msg))
+STUB(Uint16, canC_readCanAddrDipSwitches, (void))
+
+// CanFile.H
+STUB_DATA(Uint16, canF_diagOnOff)
+STUB_DATA(Uint16, dummyFileBufInCharCount)
+STUB_DATA(Uint16, dummyFileBufOutCharCount)
+STUB_DATA(Uint16, dummyFileBufOutPacketSize)
+STUB(void, canF_appendIntoDummyFileBuf, (char *src, Uint16 charCount))
+STUB(Uint16, canF_readOutOfDummyFileBuf, (char *dest, Uint16 reqCharCount))
+STUB_CAN(canF_recvDummyFile)
+STUB_CAN(canF_sendDummyFile)
+STUB(void, canF_zeroDummyFileBufCounts, (void))
+STUB(void, canF_zeroDummyFileBufOutCount, (void))
+STUB(void, diagRs232CanRecvMsg, (Uint16 mbxNumber, Uint16 *msg))
+
+// CanOpen.H
+STUB(void, canO_blockUploadTask, (void))
+STUB(Uint16, copy32BytesFromMultiPacketBufToPackedBuf, (Uint16* toPtr))
+STUB(Uint16, copyDataToMultiPacketBuf, (char* fromPtr, Uint16 count))
+STUB(Uint16, copyPacked32BytesToMultiPacketBuf, (Uint16* fromPtr))
+
+// Comint.h
+STUB(void, comint_DisplaySpeedDialList, (void))
+
+// DigIO.H
+STUB_DATA(Uint16, digio_DacAnlgOutValuesClassic[8])
+STUB_DATA(Uint16, digio_DacComparatorValuesClassic[4])
+STUB_DATA(Uint16, digio_Enc1ClassicDir)
+STUB_DATA(Uint16, digio_Enc1ClassicFreq)
+STUB_DATA(Uint16, digio_Enc1ClassicIndex)
+STUB_DATA(Uint16, digio_Enc1ManualStop)
+STUB_DATA(Uint16, digio_Enc1OutDir)
+STUB_DATA(Uint32, digio_Enc1OutFreq32)
+STUB_DATA(Uint32, digio_Enc1OutIndex32)
+STUB_DATA(Uint32, digio_Enc1StopAfterN)
+STUB_DATA(Uint16, digio_Enc2ClassicDir)
+STUB_DATA(Uint16, digio_Enc2ClassicFreq)
+STUB_DATA(Uint16, digio_Enc2ClassicIndex)
+STUB_DATA(Uint16, digio_Enc2ManualStop)
+STUB_DATA(Uint16, digio_Enc2OutDir)
+STUB_DATA(Uint32, digio_Enc2OutFreq32)
+STUB_DATA(Uint32, digio_Enc2OutIndex32)
+STUB_DATA(Uint32, digio_Enc2StopAfterN)
+STUB_DATA(Uint16, digio_HallOutputDirClassic16)
+STUB_DATA(Uint32, digio_HallOutputFreq32)
+STUB_DATA(Uint16, digio_HallOutputFreqClassic16)
+STUB_DATA(Uint16, digio_HallOutputPhaseClassic16)
+STUB_DATA(Uint16, digio_nativeDacVal[16])
+STUB_DATA(Uint32, digio_PwmOutputDutyCycl32)
+STUB_DATA(Uint16, digio_PwmOutputDutyCyclClassic16)
+STUB_DATA(Uint32, digio_PwmOutputFreq32)
+STUB_DATA(Uint16, digio_PwmOutputFreqClassic16)
+STUB(void, digio_PwmOutputFreq16Task, (void))
+STUB(void, digio_writeDacOutputValue, (Uint16 dac_index, Uint16 dac_output_value))
+STUB_CAN(digio_receiveNativeDacVal)
+STUB_CAN(digio_recvAnlgOutClassic)
+STUB_CAN(digio_recvClassicEncOutParam)
+STUB_CAN(digio_recvComparitorClassic)
+STUB_CAN(digio_recvEncOutParam)
+STUB_CAN(digio_recvHallOutputParam32)
+STUB_CAN(digio_recvHallOutputParamClassic16)
+STUB_CAN(digio_recvPwmOutputDutyCyc32)
+STUB_CAN(digio_recvPwmOutputDutyCycClassic16)
+STUB_CAN(digio_recvPwmOutputFreq32)
+STUB_CAN(digio_recvPwmOutputFreqClassic16)
+STUB_CAN(digio_send16DigitalInputs)
+
+// DigIO2.h
+STUB_DATA(Uint16, digio2_DiffOutEnable)
+STUB_DATA(Uint16, digio2_DiffOutLevel)
+STUB_DATA(Uint16, digio2_DiffOutSignalAssignment[2])
+STUB_DATA(Uint16, digio2_DigOutLevel[3])
+STUB_DATA(Uint16, digio2_DigOutMode[6])
+STUB_DATA(Uint16, digio2_DigOutRails[6])
+STUB_DATA(Uint16, digio2_DigOutSignalAssignment[6])
+STUB_DATA(Uint16, digio2_EncIndexDivisor)
+STUB_DATA(Uint16, digio2_EncInMap)
+STUB_DATA(Uint16, digio2_HallInMap)
+STUB_DATA(Uint16, digio2_PwmInMap)
+STUB_CAN(digio2_recvDiffOutEnable)
+STUB_CAN(digio2_recvDiffOutLevel)
+STUB_CAN(digio2_recvDiffOutSignalAssignment)
+STUB_CAN(digio2_recvDigOutLevel)
+STUB_CAN(digio2_recvDigOutMode)
+STUB_CAN(digio2_recvDigOutRails)
+STUB_CAN(digio2_recvDigOutSignalAssignment)
+STUB_CAN(digio2_recvEncIndexDivisor)
+STUB_CAN(digio2_recvEncInMap)
+STUB_CAN(digio2_recvHallInMap)
+STUB_CAN(digio2_recvPwmInMap)
+STUB_CAN(digio2_sendEncAInOnTime)
+STUB_CAN(digio2_sendEncAInPeriod)
+STUB_CAN(digio2_sendEncCounts)
+STUB_CAN(digio2_sendEncIInPeriod)
+STUB_CAN(digio2_sendEncInDir)
+STUB_CAN(digio2_sendEncReadingClassic)
+STUB_CAN(digio2_sendHallReadingClassic)
+STUB_CAN(digio2_sendPwmIn1OnTime)
+STUB_CAN(digio2_sendPwmIn1Period)
+STUB_CAN(digio2_sendPwmIn2OnTime)
+STUB_CAN(digio2_sendPwmIn2Period)
+STUB_CAN(digio2_sendPwmReadingClassic)
+
+// F1Int.H
+STUB(void, f1i_BgTask, (void))
+
+// F2Int.H
+STUB_DATA(Uint16, f2i_SSEnc_Alarm_Bit)
+STUB_DATA(Uint16, f2i_SSEnc_CRC_5)
+STUB_DATA(Uint16, f2i_SSEnc_Num_Pos_Bits)
+STUB_DATA(Uint16, f2i_SSEnc_Pos_1)
+STUB_DATA(Uint16, f2i_SSEnc_Pos_2)
+STUB_DATA(Uint32, f2i_SSEnc_Pos_32)
+STUB(void, f2i_BgTask_SSEnc, (void))
+STUB_CAN(f2i_recv_Pos_32_from_Host)
+
+// FlashRW.H
+STUB_DATA(union CANOPEN16_32, frwFlashAddr)
+STUB_DATA(Uint16, mcsFileRecvParseStatus)
+STUB_DATA(Uint16, mcsFileSendByteAddr)
+STUB_DATA(union CANOPEN16_32, mcsFileSendByteCount)
+STUB_CAN(frw_bulkEraseFlashRecv)
+STUB_CAN(frw_bulkEraseFlashSend)
+STUB_CAN(frw_diagDisplFlashPage)
+STUB(void, frw_diagFlashTasks, (void))
+STUB_CAN(frw_eraseSectorsRecv)
+STUB_CAN(frw_eraseSectorsSend)
+STUB_CAN(frw_fastFileRecvData)
+STUB_CAN(frw_mcsFileRecvData)
+STUB_CAN(frw_mcsFileRecvStatus)
+STUB_CAN(frw_mcsFileSendData)
+STUB_CAN(frw_mcsStreamRecvData)
+STUB(void, frw_MiscFlashTasks, (void))
+STUB_CAN(frw_readFlashRDID)
+STUB_CAN(frw_readFlashStatusReg)
+STUB_CAN(frw_readWhichFlashChip)
+STUB_CAN(frw_releasePowerdownRES)
+STUB_CAN(frw_rleStreamRecvData)
+STUB_CAN(frw_runTest2005)
+STUB(void, frw_SpiFlashTask, (void))
+STUB_CAN(frw_startLoadFpgaFromFlash)
+STUB_CAN(frw_startMcsFileRecv)
+STUB_CAN(frw_turnOnFlashWriteProtect)
+STUB_CAN(frw_writeWhichFlashChip)
+
+// FpgaTest.H
+STUB_DATA(Uint16, fpgaT_Fpga1_sv1_read)
+STUB_DATA(Uint16, fpgaT_Fpga1_sv1_write)
+STUB_DATA(Uint16, fpgaT_Fpga1_sv2_read)
+STUB_DATA(Uint16, fpgaT_Fpga1_sv2_write)
+STUB_DATA(Uint16, fpgaT_Fpga2_sv1_read)
+STUB_DATA(Uint16, fpgaT_Fpga2_sv1_write)
+STUB_DATA(Uint16, fpgaT_Fpga2_sv2_read)
+STUB_DATA(Uint16, fpgaT_Fpga2_sv2_write)
+STUB_DATA(Uint16, fpgaT_Fpga3_sv1_read)
+STUB_DATA(Uint16, fpgaT_Fpga3_sv1_write)
+STUB_DATA(Uint16, fpgaT_Fpga3_sv2_read)
+STUB_DATA(Uint16, fpgaT_Fpga3_sv2_write)
+STUB_DATA(enum SVTEST_CONTROL, fpgaT_sv_test_Control)
+STUB_DATA(Uint32, fpgaT_sv_test_Count_Tests)
+STUB_DATA(Uint16, fpgaT_sv_test_Error)
+STUB_DATA(Uint16, fpgaT_sv_test_Per_Loop)
+STUB_DATA(Uint16, fpgaT_sv_test_Throw_Error)
+STUB_DATA(Uint16, fpgaT_sv_test_which_Fpgas)
+STUB_CAN(fpgaT_send32Clk)
+STUB_CAN(fpgaT_sv_test_ctrl)
+STUB(void, fpgaT_sv_test_Task, (void))
+
+// GpioUtil.h
+STUB(void, GpioU_f2iInit, (void))
+
+// I2CEE.h
+STUB_DATA(Uint16, eeProm1ByteRWAddr)
+STUB_DATA(Uint16, eeProm32ByteRWAddr)
+STUB_DATA(Uint16, i2ceeSelectedEeprom)
+STUB_CAN(i2cee_32BytesFromEEpromToBuf)
+STUB_CAN(i2cee_32BytesFromPC)
+STUB_CAN(i2cee_32BytesToPC)
+STUB_CAN(i2cee_burn32BytesToEEProm)
+STUB(void, i2cee_burn32ToEEpromTask, (void))
+STUB(void, i2cee_diag4203Task, (void))
+STUB_CAN(i2cee_getTokenForEepromProg)
+STUB_CAN(i2cee_progEEPromFromCanFileData)
+STUB(void, i2cee_progEEPromFromCanFileTask, (void))
+STUB_CAN(i2cee_read32ByteStatus)
+STUB(void, i2cee_read32FromEEpromToBufTask, (void))
+STUB_CAN(i2cee_readEEProm1Byte)
+STUB_CAN(i2cee_readEEPromStatus)
+STUB_CAN(i2cee_readEEPromToCanFile)
+STUB(void, i2cee_readEEPromToCanFileTask, (void))
+STUB_CAN(i2cee_writeEEProm1Byte)
+
+// LED.h
+STUB_DATA(enum LED_CPLD_PATTERN, led_cpldIoPattern)
+STUB_DATA(enum LED_CPLD_PATTERN, led_cpldPmPattern)
+STUB_DATA(enum LED_FPGA_PATTERN, led_fpga1Pattern)
+STUB_DATA(enum LED_FPGA_PATTERN, led_fpga2Pattern)
+STUB_DATA(enum LED_FPGA_PATTERN, led_fpga3Pattern)
+STUB(void, led_dspLedErrMsg, (enum LED_ERROR_NUMBER count))
+STUB(void, led_setDspLedPattern, (enum LED_PATTERN pattern))
+
+// LimitChk.H
+STUB_DATA(Uint16, limChkAnlgInChannel)
+STUB_DATA(struct HI_LOW_IN_OUT_UINT16_LIMITS, limChkAnlgInLimits)
+STUB_DATA(struct HI_LOW_IN_OUT_UINT16_LIMITS, limChkAnlgInLimitsClassic)
+STUB_DATA(struct LIMIT_CHECK_TPDO, limChkTpdo[4])
+STUB_DATA(struct LIMIT_CHECK_PARAMETERS, limitCheckParams[8])
+STUB_CAN(limChkAnlgInClassic)
+STUB_CAN(limChkAnlgInComparison)
+STUB_CAN(limchkRecvEnable)
+STUB_CAN(limchkRecvLimits)
+STUB_CAN(limchkRecvStatShift)
+STUB_CAN(limchkRecvSync)
+STUB_CAN(limchkRecvTimeStartEnd)
+STUB_CAN(limchkRecvTpdoCobId)
+STUB_CAN(limchkRecvWhichInput)
+STUB_CAN(limchkResetOneChannel)
+STUB_CAN(limchkSendAvgValue)
+STUB_CAN(limchkSendFails)
+STUB_CAN(limchkSendLimits)
+STUB_CAN(limchkSendMeasValueClassic)
+STUB_CAN(limchkSendMinMaxValue)
+STUB_CAN(limchkSendTestStatus)
+STUB_CAN(limchkSendTimeStartEnd)
+STUB_CAN(limchkSendWhichInput)
+
+// Log.H
+STUB_CAN(log_clear)
+STUB_CAN(log_readLog)
+STUB_CAN(log_startReadingLog)
+STUB_CAN(log_t0Period)
+
+// Main.H
+STUB(void, main_startupTask, (void))
+
+// Resolver.H
+STUB_DATA(Uint16, res_AmpRefInOut)
+STUB_DATA(Uint16, res_attenuation)
+STUB_DATA(Uint16, res_FixedShaftAngle)
+STUB_DATA(Uint16, res_HiPrecisShaftAngle)
+STUB_DATA(Uint16, res_RefDacValue)
+STUB_DATA(Uint16, res_RefFreq)
+STUB_DATA(Uint16, res_velocity)
+STUB_CAN(res_recvAmpRef)
+STUB_CAN(res_recvRefDacValue)
+STUB_CAN(res_recvRefFreq)
+STUB_CAN(res_recvShaftAngle)
+STUB_CAN(res_recvShaftAngleIincreasedPrecision)
+STUB(void, res_ShaftAngleOutTask, (void))
+
+// RS232.h
+STUB(void, rs232_BgTask_AckAutobaud, (void))
+STUB(void, rs232_BgTask_ooad, (void))
+STUB(void, rs232_BgTask_Rs232BaudChange, (void))
+STUB(void, rs232_BgTask_Rs232BreakOrError, (void))
+STUB(void, rs232_BgTask_ts3StartUp, (void))
+STUB(void, rs232_BgTask_TxDone, (void))
+STUB(void, rs232_commandDecode, (void))
+STUB(bool, rs232_txFifo_Busy, (void))
+
+// Rs232Out.h
+STUB(void, r232Out_circBufOutput, (void))
+STUB(bool, r232Out_outChars, (char* outChars, int charLength))
+STUB(bool, r232Out_outCharsNT, (char* outChars))
+STUB(bool, r232Out_transmit_status_busy, (void))
+
+// SCI2.H
+STUB_DATA(struct SCI2_PARAMS, sci2)
+STUB_DATA(struct SCI2_BUF, sci2_Rx_Buf)
+STUB_CAN(sci2_init)
+STUB_CAN(sci2_recvTxBuf)
+STUB_CAN(sci2_recvTxBufAppend)
+STUB_CAN(sci2_sendRxBuf)
+STUB_CAN(sci2_xmit_test)
+
+// SPI.H
+STUB(void, diag_SelectSpiFlash, (void))
+STUB(void, spi_BulkEraseFlash, (void))
+STUB(Uint16, spi_ClockFlashToFpga, (Uint16 countWordsToRead))
+STUB(void, spi_ClockFlashToFpgaStart, (Uint16* address))
+STUB(void, spi_disableAllSpiDevices, ())
+STUB(bool, spi_ReadFlash, (Uint16* address, Uint16 countWordsToRead, Uint16* destBuff))
+STUB(void, spi_ReadSpiFlashRDID, (Uint16* memoryType, Uint16* memoryCapacity))
+STUB(Uint16, spi_ReadSpiFlashStatus, (void))
+STUB(Uint16, spi_ReleasePowerdownRES, (void))
+STUB(void, spi_SectorEraseFlash, (Uint16* address))
+STUB(void, spi_SetFlashWriteEnable, (void))
+STUB(bool, spi_WriteFlash, (Uint16* address, Uint16 countWordsToWrite, Uint16* sourceBuff))
+
+// SSEnc.H
+STUB_DATA(Uint16, ssEnc_HiPrecisShaftAngle)
+STUB_DATA(Uint16, ssEnc_velocity)
+STUB_CAN(ssEnc_recvShaftAngleIincreasedPrecision)
+STUB(void, ssEnc_ShaftAngleOutTask, (void))
+
+// Timer0.h
+STUB(Uint32, timer0_fetchSystemMiliSecCount, (void))
+STUB(Uint32, timer0_freeRunStamp, (void))
+STUB(void, timer0_miliSecTask, (void))
+STUB(void, timer0_task, (void))
+STUB(void, timer0_tenthOfSecTask, (void))
+
+// TimeStamp.h
+STUB_DATA(const Uint16, revision_rv1)
+STUB_DATA(const Uint16, revision_rv2)
+STUB_DATA(const Uint16, timeStamp_t1)
+STUB_DATA(const Uint16, timeStamp_t2)
+STUB_DATA(const Uint16, timeStamp_t3)
+STUB_CAN(ts_sendDateStampClassic)
+STUB_CAN(ts_sendTimeStampClassic)
@@ -0,0 +1,39 @@
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+//
+//     HostRegs.c
+//
+// The DSP's peripheral register files and the external (XINTF) address
+// space for the host tests, as plain memory, and the interrupt intrinsics.  A test that simulates interrupts links
+// SingleStep.c, or brings its own __disable_interrupts() and
+// __restore_interrupts().
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+#include "DSP281x_Device.h"
+
+volatile struct SYS_CTRL_REGS SysCtrlRegs;
+volatile struct CPUTIMER_REGS CpuTimer0Regs;
+volatile struct CPUTIMER_REGS CpuTimer1Regs;
+volatile struct CPUTIMER_REGS CpuTimer2Regs;
+volatile struct ECAN_REGS ECanaRegs;
+volatile struct ECAN_MBOXES ECanaMboxes;
+volatile struct LAM_REGS ECanaLAMRegs;
+volatile struct MOTO_REGS ECanaMOTORegs;
+volatile struct MOTS_REGS ECanaMOTSRegs;
+volatile struct GPIO_MUX_REGS GpioMuxRegs;
+volatile struct GPIO_DATA_REGS GpioDataRegs;
+volatile struct SPI_REGS SpiaRegs;
+volatile struct XINTF_REGS XintfRegs;
+volatile struct XINTRUPT_REGS XIntruptRegs;
+volatile struct PIE_CTRL_REGS PieCtrlRegs;
+struct PIE_VECT_TABLE PieVectTable;
+volatile Uint16 IER;
+volatile Uint16 IFR;
+volatile Uint16 hostXintf[HOST_XINTF_WORDS];
+
+__attribute__((weak)) Uint16 __disable_interrupts(void){
+	return 0;
+}
+
+__attribute__((weak)) void __restore_interrupts(Uint16 intState){
+	(void)intState;
+}
@@ -0,0 +1,257 @@
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+//
+//     I2cEeAckPoll.c
+//
+// Host test for programming the I2C EEProm with acknowledge polling in
+// I2CEE.C, against the 24LC02B on the GPIO pins in I2cEeSim.c, which does
+// not answer for 5 mSec (tWR) after each page write.  The background tasks
+// run off the task manager's timer wheel, ticked each simulated mSec.
+//  1. 0x2047-style programming from the CanFile buffer,
+//     i2cee_progEEPromFromCanFileTask(): 256 random bytes, 32 pages, must
+//     be in the EEProm byte for byte, read back through
+//     i2cee_readEEPromToCanFileTask() too.  No page may be started while
+//     the chip is busy, and the whole takes about 32 x (5 mSec + a poll
+//     period + the bus time) -- against 3.2 sec with the fixed 0.1 sec
+//     per page it used to wait.
+//  2. i2cee_burn32ToEEpromTask(): 32 bytes at an address, 4 pages, the
+//     rest of the EEProm untouched.
+//  3. a chip that never finishes its write cycle: both tasks give up with
+//     their WRITING_EEFAIL status after I2CEE_ACK_POLL_LIMIT polls, write
+//     protect back on.
+//
+//     I2cEeAckPoll
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "DSP281x_Device.h"
+#include "stdbool.h"
+#include "CanOpen.H"
+#include "CanFile.H"
+#include "I2CEE.h"
+#include "TaskMgr.h"
+#include "Timer0.h"
+#include "I2cEeSim.h"
+
+// I2CEE.C and TaskMgr.c internals
+extern enum I2CEE_CANFILESTATUS i2ceeCanFileStatus;
+extern enum I2CEE_32BYTESTATUS i2cee32ByteStatus;
+extern Uint16 packed32ByteBuf[16];
+extern Uint16 taskReadyFlags[MAX_TASKFLAG_WORDS];
+
+#define OLD_FIXED_WAIT_MS 3200L		// 32 pages x 0.1 sec
+
+static int fails;
+#define CHECK(c, ...) do { if (!(c)) { printf("FAIL %s:%d ", __FILE__, __LINE__); \
+	printf(__VA_ARGS__); printf("\n"); fails++; if (fails > 10) exit(1); } } while (0)
+
+static unsigned char image[I2C_EE_SIM_BYTES];
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// simulated time: the tasks run back to back, the timer wheel ticks at each
+// whole mSec of i2cEeSim_us, and with nothing ready time skips to the tick
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+static int anyTaskReady(void){
+	Uint16 i;
+
+	for (i = 0; i < MAX_TASKFLAG_WORDS; i++){
+		if (taskReadyFlags[i]) return 1;
+	}
+	return 0;
+}
+
+static int canFileWriting(void){
+	return i2ceeCanFileStatus == I2CEE_CFS_WRITING_EEPROM;
+}
+
+static int canFileReading(void){
+	return i2ceeCanFileStatus == I2CEE_CFS_READING_EEPROM;
+}
+
+static int burning32(void){
+	return i2cee32ByteStatus == I2CEE_32BYTE_WRITING_EEPROM;
+}
+
+// run while busy(), or for limitMs; returns the mSec it took
+static double runWhile(int (*busy)(void), long limitMs){
+	double start = i2cEeSim_us;
+	double nextTick = ((long)(i2cEeSim_us / 1000) + 1) * 1000.0;
+
+	while (busy() && (i2cEeSim_us - start < limitMs * 1000.0)){
+		if (anyTaskReady()) {
+			taskMgr_runBkgndTasks();
+		} else {
+			i2cEeSim_us = nextTick;
+		}
+		while (i2cEeSim_us >= nextTick){
+			taskMgr_tickDelayWheel();
+			nextTick += 1000;
+		}
+	}
+	return (i2cEeSim_us - start) / 1000;
+}
+
+// Log.C time stamps its records with these (Timer0.c is not linked)
+Uint32 timer0_interrupt_count_value(void){
+	return (Uint32)(i2cEeSim_us / 1000);
+}
+
+Uint32 timer0_count_reg_value(void){
+	return (Uint32)(i2cEeSim_us * 150) % 150000L;
+}
+
+static void startUp(void){
+	i2cEeSim_reset();
+	taskMgr_init();
+	i2cee_Init();
+	i2cee_selectEEProm(I2CEE_SEL_TB3CM);
+}
+
+static Uint16 token(void){
+	Uint16 data[4] = {0, 0, 0, 0};
+
+	i2cee_getTokenForEepromProg(NULL, data);
+	return data[2];
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// 1. the whole EEProm from the CanFile buffer
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+static double programFromCanFile(void){
+	Uint16 data[4] = {0, 0, 0, 0};
+	char chars[I2C_EE_SIM_BYTES];
+	Uint16 i;
+
+	for (i = 0; i < I2C_EE_SIM_BYTES; i++){
+		chars[i] = image[i];
+	}
+	canF_zeroDummyFileBufCounts();
+	canF_appendIntoDummyFileBuf(chars, I2C_EE_SIM_BYTES);
+	data[2] = token();
+	CHECK(i2cee_progEEPromFromCanFileData(NULL, data) == CANOPEN_NO_ERR, "token refused");
+	return runWhile(canFileWriting, 10000);
+}
+
+static void wholeEEProm(void){
+	Uint16 data[4] = {0, 0, 0, 0};
+	char back[I2C_EE_SIM_BYTES];
+	double ms;
+	Uint16 i, n;
+
+	startUp();
+	for (i = 0; i < I2C_EE_SIM_BYTES; i++){
+		image[i] = rand();
+	}
+	ms = programFromCanFile();
+	CHECK(i2ceeCanFileStatus == I2CEE_CFS_WRITING_EEDONE, "CanFile programming status %d", i2ceeCanFileStatus);
+	CHECK(memcmp(i2cEeSim_mem, image, sizeof image) == 0, "EEProm does not hold the CanFile data");
+	CHECK(i2cEeSim_writeCycles == I2C_EE_SIM_BYTES / I2C_EE_SIM_PAGE, "%ld page writes, not %d",
+		i2cEeSim_writeCycles, I2C_EE_SIM_BYTES / I2C_EE_SIM_PAGE);
+	CHECK(i2cEeSim_errors == 0, "%ld page writes wrapped or were write protected", i2cEeSim_errors);
+	CHECK(i2cEeSim_busyNacks > 0, "never found the EEProm busy: not acknowledge polling?");
+	CHECK(ms < OLD_FIXED_WAIT_MS / 8, "%.1f mSec to program 256 bytes", ms);
+	printf("256 bytes from the CanFile buffer: %.1f mSec (%.0f with the fixed 0.1 sec wait), "
+		"%ld write cycles, %ld polls NACK'd\n", ms, (double)OLD_FIXED_WAIT_MS, i2cEeSim_writeCycles,
+		i2cEeSim_busyNacks);
+
+	// and back, through the EEProm read task
+	i2cee_readEEPromToCanFile(NULL, data);
+	runWhile(canFileReading, 10000);
+	CHECK(i2ceeCanFileStatus == I2CEE_CFS_READING_EEDONE, "CanFile read status %d", i2ceeCanFileStatus);
+	canF_zeroDummyFileBufOutCount();
+	n = canF_readOutOfDummyFileBuf(back, I2C_EE_SIM_BYTES);
+	CHECK(n == I2C_EE_SIM_BYTES, "read back %u bytes", n);
+	for (i = 0; i < n; i++){
+		if ((unsigned char)back[i] != image[i]) {
+			CHECK(0, "read back byte %u: %02X, wrote %02X", i, (unsigned char)back[i], image[i]);
+			break;
+		}
+	}
+
+	// straight away again: the first page must wait for the last write cycle
+	for (i = 0; i < I2C_EE_SIM_BYTES; i++){
+		image[i] = ~image[i];
+	}
+	programFromCanFile();
+	i2cEeSim_busyNacks = 0;
+	programFromCanFile();
+	CHECK(i2ceeCanFileStatus == I2CEE_CFS_WRITING_EEDONE, "back to back: status %d", i2ceeCanFileStatus);
+	CHECK(memcmp(i2cEeSim_mem, image, sizeof image) == 0, "back to back: EEProm does not hold the data");
+	CHECK(i2cEeSim_errors == 0, "back to back: %ld bad page writes", i2cEeSim_errors);
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// 2. 32 bytes at an address
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+static double burn32(Uint16 eepromAddr){
+	Uint16 data[4] = {0, 0, 0, 0};
+	Uint16 i;
+
+	for (i = 0; i < 16; i++){
+		packed32ByteBuf[i] = (image[eepromAddr + 2 * i] << 8) | image[eepromAddr + 2 * i + 1];
+	}
+	eeProm32ByteRWAddr = eepromAddr;
+	data[2] = token();
+	CHECK(i2cee_burn32BytesToEEProm(NULL, data) == CANOPEN_NO_ERR, "token refused");
+	return runWhile(burning32, 10000);
+}
+
+static void thirtyTwoBytes(void){
+	Uint16 addr, i;
+	double ms;
+
+	startUp();
+	memset(image, 0xFF, sizeof image);
+	for (addr = 0; addr < I2C_EE_SIM_BYTES; addr += 64){
+		for (i = 0; i < 32; i++){
+			image[addr + i] = rand();
+		}
+		ms = burn32(addr);
+		CHECK(i2cee32ByteStatus == I2CEE_32BYTE_WRITING_EEDONE, "32 bytes at %u: status %d", addr, i2cee32ByteStatus);
+	}
+	CHECK(memcmp(i2cEeSim_mem, image, sizeof image) == 0, "EEProm does not hold the 32-byte writes, or more");
+	CHECK(i2cEeSim_writeCycles == 4 * 4, "%ld page writes, not 16", i2cEeSim_writeCycles);
+	CHECK(i2cEeSim_errors == 0, "%ld page writes wrapped or were write protected", i2cEeSim_errors);
+	printf("32 bytes: %.1f mSec\n", ms);
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// 3. an EEProm that stays busy
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+static void neverReady(void){
+	double ms;
+
+	startUp();
+	for (ms = 0; ms < I2C_EE_SIM_BYTES; ms++){
+		image[(int)ms] = rand();
+	}
+	i2cEeSim_stuckBusy(1);
+	ms = programFromCanFile();
+	CHECK(i2ceeCanFileStatus == I2CEE_CFS_WRITING_EEFAIL, "stuck EEProm, CanFile status %d", i2ceeCanFileStatus);
+	CHECK(i2cEeSim_busyNacks == I2CEE_ACK_POLL_LIMIT + 1, "CanFile: %ld polls before giving up", i2cEeSim_busyNacks);
+	CHECK(ms < I2CEE_ACK_POLL_LIMIT * I2CEE_ACK_POLL_PERIOD_MS + 5, "CanFile: gave up after %.1f mSec", ms);
+	CHECK(!(GpioDataRegs.GPADAT.all & 0x8000), "CanFile: write protect left off");
+
+	// part way: the first pages go in, then the chip hangs
+	i2cEeSim_stuckBusy(0);
+	burn32(0);
+	i2cEeSim_busyNacks = 0;
+	i2cEeSim_stuckBusy(1);
+	burn32(64);
+	CHECK(i2cee32ByteStatus == I2CEE_32BYTE_WRITING_EEFAIL, "stuck EEProm, 32-byte status %d", i2cee32ByteStatus);
+	CHECK(i2cEeSim_busyNacks == I2CEE_ACK_POLL_LIMIT + 2, "32 bytes: %ld polls before giving up", i2cEeSim_busyNacks);
+	CHECK(!(GpioDataRegs.GPADAT.all & 0x8000), "32 bytes: write protect left off");
+	CHECK(memcmp(i2cEeSim_mem, image, 32) == 0, "first 32 bytes lost");
+	printf("EEProm stuck busy: %.1f mSec to give up\n", ms);
+}
+
+int main(void){
+	srand(11);
+	wholeEEProm();
+	thirtyTwoBytes();
+	neverReady();
+	printf(fails ? "FAIL (%d)\n" : "PASS\n", fails);
+	return fails != 0;
+}
@@ -0,0 +1,222 @@
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+//
+//     I2cEeBusTiming.c
+//
+// Host test for the Timer0-paced i2cee_delay() in I2CEE.C: the bus timing
+// i2cee_write() and i2cee_read() put on the pins, timed in CPU cycles on
+// the simulated Timer0 in I2cEeSim.c, which reloads every 200 uSec.
+//  - every interval the I2C Fast-mode spec sets a minimum for: Clk LOW
+//    1.3 uSec, Clk HI 0.6, data setup 0.1, START setup and hold 0.6, STOP
+//    setup 0.6, bus free from STOP to START 1.3
+//  - no two changes closer than I2CEE_DELAY_CYCLES, whatever a Timer0 read
+//    or a GPIO write costs, wherever the reloads fall, and with "interrupts"
+//    stretching some delays, short and long
+//  - without interrupts Clk runs at 250 - 400kHz, about 330 at 8 cycles a
+//    Timer0 read
+//  - with Timer0 stopped the bus still runs, at about the old 40kHz
+//    (20 - 80kHz)
+// and the EEProm must read back what was written, every time.
+//
+//     I2cEeBusTiming [rounds per configuration]
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "DSP281x_Device.h"
+#include "stdbool.h"
+#include "CanOpen.H"
+#include "I2CEE.h"
+#include "Timer0.h"
+#include "I2cEeSim.h"
+
+#define CYCLES_PER_US 150.0
+
+// I2CEE.C internals
+bool i2cee_read(Uint16* dataBuf, Uint16 countBytesToRead, Uint16 eepromAddr);
+
+static int fails;
+#define CHECK(c, ...) do { if (!(c)) { printf("FAIL %s:%d ", __FILE__, __LINE__); \
+	printf(__VA_ARGS__); printf("\n"); fails++; if (fails > 10) exit(1); } } while (0)
+
+// Log.C time stamps its records with these (Timer0.c is not linked)
+Uint32 timer0_interrupt_count_value(void){
+	return (Uint32)(i2cEeSim_us / 200);
+}
+
+Uint32 timer0_count_reg_value(void){
+	return 0;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// the bus as I2cEeSim.c reports it, change by change
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+struct BUS {
+	int clk, data;
+	double last;		// previous change
+	double clkRise, clkFall, dataChange, start, stop;
+	int startSinceRise;
+	double minGap;					// cycles
+	double sclRises, sclUs;			// for the Clk rate in bytes
+	long changes;
+};
+static struct BUS bus;
+
+// spec minimums, uSec
+#define T_LOW     1.3
+#define T_HIGH    0.6
+#define T_SU_DAT  0.1
+#define T_SU_STA  0.6
+#define T_HD_STA  0.6
+#define T_SU_STO  0.6
+#define T_BUF     1.3
+
+static void minimum(const char* what, double us, double min){
+	CHECK(us >= min - 1e-9, "%s %.3f uSec, spec min %.1f (at %.3f uSec)", what, us, min, bus.last);
+}
+
+static void onChange(double us, int clk, int data){
+	double gap = (us - bus.last) * CYCLES_PER_US;
+
+	if (bus.changes > 0) {
+		if (gap < bus.minGap) bus.minGap = gap;
+	}
+	bus.changes++;
+	bus.last = us;
+
+	if (clk && !bus.clk) {
+		minimum("Clk LOW", us - bus.clkFall, T_LOW);
+		if (bus.dataChange > bus.clkFall) minimum("data setup", us - bus.dataChange, T_SU_DAT);
+		if (us - bus.clkRise < 50) {		// within a transfer
+			bus.sclUs += us - bus.clkRise;
+			bus.sclRises++;
+		}
+		bus.clkRise = us;
+		bus.startSinceRise = 0;
+	} else if (!clk && bus.clk) {
+		minimum("Clk HI", us - bus.clkRise, T_HIGH);
+		if (bus.startSinceRise) minimum("START hold", us - bus.start, T_HD_STA);
+		bus.clkFall = us;
+	}
+	if (data != bus.data) {
+		if (clk && bus.clk) {
+			if (!data) {
+				minimum("START setup", us - bus.clkRise, T_SU_STA);
+				minimum("bus free", us - bus.stop, T_BUF);
+				bus.start = us;
+				bus.startSinceRise = 1;
+			} else {
+				minimum("STOP setup", us - bus.clkRise, T_SU_STO);
+				bus.stop = us;
+			}
+		} else {
+			bus.dataChange = us;
+		}
+	}
+	bus.clk = clk;
+	bus.data = data;
+}
+
+static void busReset(void){
+	bus.clk = 1;
+	bus.data = 1;
+	bus.changes = 0;
+	bus.last = bus.clkRise = bus.clkFall = bus.dataChange = bus.start = bus.stop = -1e9;	// long ago
+	bus.startSinceRise = 0;
+	bus.minGap = 1e9;
+	bus.sclRises = bus.sclUs = 0;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// a page written and read back
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+static void writeAndRead(void){
+	Uint16 out[I2CEE_PAGE_SIZE / 2], in[I2CEE_PAGE_SIZE / 2];
+	Uint16 addr = (rand() % (256 / I2CEE_PAGE_SIZE)) * I2CEE_PAGE_SIZE;
+	Uint16 i;
+
+	for (i = 0; i < I2CEE_PAGE_SIZE / 2; i++){
+		out[i] = rand();
+	}
+	i2cee_writeProtect(I2CEE_WP_OFF);
+	CHECK(i2cee_write(out, I2CEE_PAGE_SIZE, addr), "write at %u: no ACK", addr);
+	i2cee_writeProtect(I2CEE_WP_ON);
+	i2cEeSim_us += i2cEeSim_writeCycleUs + (rand() % 30000) / CYCLES_PER_US;	// tWR, and somewhere in the Timer0 period
+	CHECK(i2cee_read(in, I2CEE_PAGE_SIZE, addr), "read at %u: no ACK", addr);
+	for (i = 0; i < I2CEE_PAGE_SIZE / 2; i++){
+		CHECK(in[i] == out[i], "at %u: read %04X, wrote %04X", addr + 2 * i, in[i], out[i]);
+	}
+	i2cEeSim_us += (rand() % 30000) / CYCLES_PER_US;
+}
+
+static void startUp(void){
+	i2cEeSim_reset();
+	i2cEeSim_onChange = onChange;
+	i2cee_Init();
+	i2cee_selectEEProm(I2CEE_SEL_TB3CM);
+	busReset();
+}
+
+// every cost of a Timer0 read and a GPIO write, each with and without
+// interrupts
+static void paced(long rounds){
+	static const double readCost[] = {4, 6, 8, 11, 14};
+	static const double gpioCost[] = {2, 4, 7};
+	static const struct { long every; double cycles; } isr[] = {{0, 0}, {7, 150}, {23, 2000}};
+	unsigned r, g, k;
+	long n, changes = 0;
+	double minGap = 1e9, khz, khzMin = 1e9, khzMax = 0;
+
+	for (k = 0; k < sizeof isr / sizeof isr[0]; k++){
+		for (r = 0; r < sizeof readCost / sizeof readCost[0]; r++){
+			for (g = 0; g < sizeof gpioCost / sizeof gpioCost[0]; g++){
+				startUp();
+				i2cEeSim_cyclesPerTimerRead = readCost[r];
+				i2cEeSim_cyclesPerGpioAccess = gpioCost[g];
+				i2cEeSim_isrEvery = isr[k].every;
+				i2cEeSim_isrCycles = isr[k].cycles;
+				for (n = 0; n < rounds; n++){
+					writeAndRead();
+				}
+				CHECK(bus.minGap >= I2CEE_DELAY_CYCLES, "Timer0 read %.0f, GPIO %.0f cycles: changes %.1f cycles apart",
+					readCost[r], gpioCost[g], bus.minGap);
+				if (bus.minGap < minGap) minGap = bus.minGap;
+				changes += bus.changes;
+				if (isr[k].every == 0) {
+					khz = 1000 * bus.sclRises / bus.sclUs;
+					CHECK(khz > 250 && khz <= 400, "Timer0 read %.0f, GPIO %.0f cycles: Clk %.0f kHz",
+						readCost[r], gpioCost[g], khz);
+					if (khz < khzMin) khzMin = khz;
+					if (khz > khzMax) khzMax = khz;
+					if (readCost[r] == 8) printf("Timer0 read 8, GPIO %.0f cycles: Clk %.0f kHz\n", gpioCost[g], khz);
+				}
+			}
+		}
+	}
+	printf("Timer0 paced: %ld changes, at least %.0f cycles apart, Clk %.0f - %.0f kHz\n",
+		changes, minGap, khzMin, khzMax);
+}
+
+static void timerStopped(void){
+	double khz;
+	long n;
+
+	startUp();
+	i2cEeSim_timerStopped = 1;
+	for (n = 0; n < 50; n++){
+		writeAndRead();
+	}
+	khz = 1000 * bus.sclRises / bus.sclUs;
+	CHECK(khz > 20 && khz < 80, "Timer0 stopped: Clk %.0f kHz", khz);
+	printf("Timer0 stopped: Clk %.0f kHz\n", khz);
+}
+
+int main(int argc, char** argv){
+	long rounds = (argc > 1) ? atol(argv[1]) : 200;
+
+	srand(13);
+	paced(rounds);
+	timerStopped();
+	printf(fails ? "FAIL (%d)\n" : "PASS\n", fails);
+	return fails != 0;
+}
@@ -0,0 +1,256 @@
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+//
+//     I2cEeSim.c
+//
+// See I2cEeSim.h.
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+#include <string.h>
+
+#include "DSP281x_Device.h"
+#include "I2cEeSim.h"
+
+#undef GpioDataRegs
+#undef CpuTimer0Regs
+
+#define CLK      0x0100
+#define DATA     0x0800
+#define CLK_ENA  0x4000	// LOW = Clk buffer to the EEProm enabled
+#define WR_ENA   0x8000	// HI = write enabled
+#define CYCLES_PER_US 150
+#define TIMER0_PRD 29999L
+
+unsigned char i2cEeSim_mem[I2C_EE_SIM_BYTES];
+double i2cEeSim_us;
+double i2cEeSim_cyclesPerGpioAccess = 4;
+double i2cEeSim_cyclesPerTimerRead = 8;
+int i2cEeSim_timerStopped;
+long i2cEeSim_isrEvery;
+double i2cEeSim_isrCycles;
+void (*i2cEeSim_onChange)(double us, int clk, int data);
+double i2cEeSim_writeCycleUs = 5000;
+long i2cEeSim_writeCycles;
+long i2cEeSim_busyNacks;
+long i2cEeSim_errors;
+
+static volatile struct GPIO_DATA_REGS regs;
+static volatile struct CPUTIMER_REGS timer0;
+static double lastAccessUs;	// when the GPIO write sync() applies was made
+static long timerReads;
+static Uint16 latch;		// GPIOA output latch
+static int clkPin;			// Clk as the EEProm sees it, through its buffer
+static int dataPin;			// the Data line: pulled up, either side may pull it LOW
+static int eeDrivesLow;
+static int dspDataWas;		// Data as the DSP drives it, HI as an input
+
+enum EE_STATE { EE_IDLE, EE_CONTROL, EE_WORD_ADDR, EE_DATA_IN, EE_DATA_OUT, EE_IGNORE };
+static enum EE_STATE state;
+static int clocks;			// Clk rising edges in this byte, 9th is the ACK
+static Uint16 shift;		// byte coming in
+static Uint16 outByte;		// byte going out
+static int masterAck;
+static Uint16 addr;
+static unsigned char pageBuf[I2C_EE_SIM_PAGE];
+static Uint16 pageTouched;	// bit per byte of pageBuf
+static Uint16 pageAddr;
+static int pageBytes;
+static double busyUntil;
+static int stuck;
+
+void i2cEeSim_reset(void){
+	memset(i2cEeSim_mem, 0xFF, sizeof i2cEeSim_mem);
+	memset((void*)&regs, 0, sizeof regs);
+	latch = CLK | DATA | CLK_ENA;
+	GpioMuxRegs.GPADIR.all |= CLK | DATA;
+	clkPin = 1;
+	dataPin = 1;
+	eeDrivesLow = 0;
+	dspDataWas = 1;
+	state = EE_IDLE;
+	clocks = 0;
+	pageTouched = 0;
+	pageBytes = 0;
+	busyUntil = 0;
+	stuck = 0;
+	i2cEeSim_us = 0;
+	lastAccessUs = 0;
+	i2cEeSim_timerStopped = 0;
+	i2cEeSim_isrEvery = 0;
+	timerReads = 0;
+	memset((void*)&timer0, 0, sizeof timer0);
+	timer0.PRD.all = TIMER0_PRD;
+	timer0.TIM.all = TIMER0_PRD;
+	i2cEeSim_writeCycles = 0;
+	i2cEeSim_busyNacks = 0;
+	i2cEeSim_errors = 0;
+	regs.GPADAT.all = latch;
+}
+
+void i2cEeSim_stuckBusy(int on){
+	stuck = on;
+	if (!on) busyUntil = i2cEeSim_us;
+}
+
+static int busy(void){
+	return stuck || (i2cEeSim_us < busyUntil);
+}
+
+static void startOfPage(void){
+	pageAddr = addr & ~(I2C_EE_SIM_PAGE - 1);
+	pageTouched = 0;
+	pageBytes = 0;
+}
+
+static void burnPage(void){
+	Uint16 i;
+
+	if (pageBytes == 0) return;		// no data: an address set for a read, or an ACK poll
+	if (!(latch & WR_ENA)) {
+		i2cEeSim_errors++;
+		return;
+	}
+	if (pageBytes > I2C_EE_SIM_PAGE) {
+		i2cEeSim_errors++;			// wrapped, and overwrote the start of the page
+	}
+	for (i = 0; i < I2C_EE_SIM_PAGE; i++){
+		if (pageTouched & (1 << i)) {
+			i2cEeSim_mem[pageAddr + i] = pageBuf[i];
+		}
+	}
+	i2cEeSim_writeCycles++;
+	busyUntil = i2cEeSim_us + i2cEeSim_writeCycleUs;
+}
+
+// a whole byte in: ACK it or not
+static int byteIn(void){
+	switch (state){
+	case EE_CONTROL:
+		if ((shift & 0xFE) != 0xA0) {
+			state = EE_IGNORE;
+			return 0;
+		}
+		if (busy()) {
+			i2cEeSim_busyNacks++;
+			state = EE_IGNORE;
+			return 0;
+		}
+		if (shift & 1) {
+			state = EE_DATA_OUT;
+			masterAck = 1;			// the first byte goes out after this ACK
+		} else {
+			state = EE_WORD_ADDR;
+		}
+		return 1;
+	case EE_WORD_ADDR:
+		addr = shift & 0xFF;
+		startOfPage();
+		state = EE_DATA_IN;
+		return 1;
+	case EE_DATA_IN:
+		pageBuf[addr & (I2C_EE_SIM_PAGE - 1)] = shift;
+		pageTouched |= 1 << (addr & (I2C_EE_SIM_PAGE - 1));
+		pageBytes++;
+		addr = pageAddr | ((addr + 1) & (I2C_EE_SIM_PAGE - 1));
+		return 1;
+	default:
+		return 0;
+	}
+}
+
+static void clkRise(void){
+	clocks++;
+	if (clocks <= 8) {
+		shift = ((shift << 1) | dataPin) & 0xFF;
+	} else if ((clocks == 9) && (state == EE_DATA_OUT)) {
+		masterAck = !dataPin;
+	}
+}
+
+static void clkFall(void){
+	if (clocks == 8) {
+		if (state == EE_DATA_OUT) {
+			eeDrivesLow = 0;			// let go, for the master's ACK
+		} else {
+			eeDrivesLow = byteIn();		// ACK
+		}
+	} else if (clocks == 9) {
+		clocks = 0;
+		eeDrivesLow = 0;
+		if (state == EE_DATA_OUT) {
+			if (masterAck) {			// read control byte, or ACK'd: next byte
+				outByte = i2cEeSim_mem[addr];
+				addr = (addr + 1) & (I2C_EE_SIM_BYTES - 1);
+				eeDrivesLow = !(outByte & 0x80);
+			} else {
+				state = EE_IGNORE;
+			}
+		}
+	} else if ((state == EE_DATA_OUT) && (clocks >= 1)) {
+		eeDrivesLow = !((outByte << clocks) & 0x80);
+	}
+}
+
+// apply the GPASET / GPACLEAR write made since the last access, and run the
+// EEProm on what it did to the lines
+static void sync(void){
+	int clk, data, dspData, lineChange = 0;
+
+	latch = (latch | regs.GPASET.all) & ~regs.GPACLEAR.all;
+	regs.GPASET.all = 0;
+	regs.GPACLEAR.all = 0;
+
+	dspData = !(GpioMuxRegs.GPADIR.all & DATA) || (latch & DATA);
+	if (((latch ^ regs.GPADAT.all) & CLK) || (dspData != dspDataWas)) {
+		lineChange = 1;
+		dspDataWas = dspData;
+	}
+	clk = (latch & CLK_ENA) ? 1 : ((latch & CLK) != 0);
+	if (clk != clkPin) {
+		clkPin = clk;
+		if (clk) {
+			clkRise();
+		} else {
+			clkFall();
+		}
+	}
+	data = !eeDrivesLow && (!(GpioMuxRegs.GPADIR.all & DATA) || (latch & DATA));
+	if (data != dataPin) {
+		dataPin = data;
+		if (clkPin) {
+			if (data) {						// STOP
+				if (state == EE_DATA_IN) burnPage();
+				state = EE_IDLE;
+			} else {						// START, or repeated START
+				if (state == EE_DATA_IN) pageBytes = 0;	// a write that is not STOPped is dropped
+				state = EE_CONTROL;
+			}
+			clocks = 0;
+			eeDrivesLow = 0;
+			dataPin = !(GpioMuxRegs.GPADIR.all & DATA) || (latch & DATA);
+		}
+	}
+	regs.GPADAT.all = (latch & ~DATA) | (dataPin ? DATA : 0);
+	if (lineChange && i2cEeSim_onChange) {
+		i2cEeSim_onChange(lastAccessUs, (latch & CLK) != 0, dspData);
+	}
+}
+
+volatile struct GPIO_DATA_REGS* i2cEeSim_gpioData(void){
+	sync();
+	lastAccessUs = i2cEeSim_us;
+	i2cEeSim_us += i2cEeSim_cyclesPerGpioAccess / CYCLES_PER_US;
+	return &regs;
+}
+
+volatile struct CPUTIMER_REGS* i2cEeSim_timer0(void){
+	long long cycles = (long long)(i2cEeSim_us * CYCLES_PER_US);
+
+	if (!i2cEeSim_timerStopped) {
+		timer0.TIM.all = timer0.PRD.all - (Uint32)(cycles % ((long long)timer0.PRD.all + 1));
+	}
+	i2cEeSim_us += i2cEeSim_cyclesPerTimerRead / CYCLES_PER_US;
+	if (i2cEeSim_isrEvery && (++timerReads % i2cEeSim_isrEvery == 0)) {
+		i2cEeSim_us += i2cEeSim_isrCycles / CYCLES_PER_US;
+	}
+	return &timer0;
+}
@@ -0,0 +1,64 @@
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+//
+//     I2cEeSim.h
+//
+// The TB3CM 24LC02B I2C EEProm as the host tests need it, on the GPIO pins
+// I2CEE.C bit-bangs (TB3CMB_GPIO): Clk GPIOA8, Data GPIOA11, Clk buffer
+// enable GPIOA14 (LOW = enabled), write enable GPIOA15 (HI = enabled).
+// A test built with
+//     -DGpioDataRegs=(*i2cEeSim_gpioData())
+// sends every GpioDataRegs access through i2cEeSim_gpioData(), which first
+// applies the GPASET / GPACLEAR write before it to the pins, runs the
+// EEProm on any change of Clk or Data, and puts the Data line back in
+// GPADAT for the read that may follow.
+//  - 256 bytes, 8-byte page write buffer: a page write wraps within its
+//    page as the chip does, and is burnt at the STOP
+//  - after the STOP of a write the chip is in its write cycle for
+//    i2cEeSim_writeCycleUs (5 mSec, tWR), and does not acknowledge its
+//    control byte -- which is what acknowledge polling looks for
+//  - with write enable off the data bytes are ACK'd, but nothing is
+//    written and there is no write cycle
+// Timer0, which i2cee_delay() paces the bus by, goes through here too in a
+// test built with
+//     -DCpuTimer0Regs=(*i2cEeSim_timer0())
+// Time: i2cEeSim_us, 150 CPU cycles a uSec.  Each GpioDataRegs access and
+// each CpuTimer0Regs access takes the cycles set below, an "interrupt"
+// adds its ISR's, and the test advances it for time spent outside I2CEE.C.
+// The Timer0 count register counts down from PRD (29999: the firmware's
+// 200 uSec period) and reloads, unless i2cEeSim_timerStopped.
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+#ifndef I2CEESIM_H
+#define I2CEESIM_H
+
+#define I2C_EE_SIM_BYTES 256
+#define I2C_EE_SIM_PAGE  8
+
+extern unsigned char i2cEeSim_mem[I2C_EE_SIM_BYTES];
+extern double i2cEeSim_us;
+extern double i2cEeSim_cyclesPerGpioAccess;
+extern double i2cEeSim_cyclesPerTimerRead;
+extern int i2cEeSim_timerStopped;
+extern long i2cEeSim_isrEvery;		// an "interrupt" of i2cEeSim_isrCycles every so many
+extern double i2cEeSim_isrCycles;	// Timer0 reads, 0 = none
+extern double i2cEeSim_writeCycleUs;
+extern long i2cEeSim_writeCycles;	// page writes burnt
+extern long i2cEeSim_busyNacks;		// control bytes not ACK'd during a write cycle
+extern long i2cEeSim_errors;		// page writes that wrapped, or came with write enable off
+
+// called at each change the DSP makes to Clk or Data, with the time of the
+// GPIO write that made it, and Clk and Data as the DSP drives them (Data HI
+// while it is an input)
+extern void (*i2cEeSim_onChange)(double us, int clk, int data);
+
+// all 0xFF, bus idle (Clk, Data HI, as outputs), not busy, counts zeroed,
+// time 0, Timer0 running
+void i2cEeSim_reset(void);
+
+// the chip never finishes its write cycle (busy from now on), or does again
+void i2cEeSim_stuckBusy(int stuck);
+
+volatile struct GPIO_DATA_REGS* i2cEeSim_gpioData(void);
+volatile struct CPUTIMER_REGS* i2cEeSim_timer0(void);
+
+#endif
@@ -0,0 +1,685 @@
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+//
+//     LimChkPdo.c
+//
+// Host test of the limit-check transmit PDOs: limChkTpdoService() run from
+// limChkStateMachine() every mSec, canC_pdoTransmit() loading Tx mailboxes
+// 0 - 3, and 202B configured over SDO, through the real CanOpen.C,
+// CanComm.C and task manager, on the bus ECanSim.c simulates -- at most
+// FRAMES_PER_MS frames a mSec, and held now and then as if other nodes had
+// it.  The PC side sees each frame with the mSec it left in.
+//  1. defaults: every TPDO off, nothing on the bus, COB IDs 0x180 - 0x480
+//     + node read back with bit 31 set; COB IDs refused (0, extended, our
+//     SDO ones, bit 30) and a COB ID taken moving the mailbox to it
+//  2. status (TPDO1): sent at once when turned on, on every change no sooner
+//     than the inhibit time after the last one, the last change always
+//     getting out, every event timer mSec with no change (the mSec stamp
+//     is not a change), never on a timer of 0; channel state changed by
+//     the PC enabling a test over SDO; sent at once when turned on with a
+//     timer of 0 too
+//  3. measurements (TPDO2/3): every event timer mSec to the mSec, periodic
+//     only or on change too, channels by mapping, classic values
+//  4. statistics (TPDO4): one channel, or taking turns through all 8; min
+//     and max swapped for ANLG_IN_5678
+//  5. bus held: a TPDO's frame still waiting in its mailbox is not loaded
+//     again; once it leaves, the next one carries the latest data; the SDO
+//     traffic alongside is answered in order
+//  6. all 8 channels watched at 10 Hz, by SDO polling and by PDO: frames a
+//     second, and how long a test status change takes to reach the PC
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "DSP281x_Device.h"
+#include "stdbool.h"
+#include "CanOpen.H"
+#include "CanComm.H"
+#include "LimitChk.H"
+#include "TaskMgr.h"
+#include "Log.H"
+#include "ECanSim.h"
+
+// LimitChk.C's, not in LimitChk.H
+Uint16 limchkConvertNativeToClassic(Uint32 nativeValue, enum IO_TYPE ioType);
+
+#define FRAMES_PER_MS 4			// 8-byte frames at 500 kbit/s, 250 uSec or so each
+#define PASSES_PER_MS 20		// background loop
+#define MAX_SEEN 20000
+
+static int fails;
+#define CHECK(c, ...) do { if (!(c)) { printf("FAIL %s:%d ", __FILE__, __LINE__); \
+	printf(__VA_ARGS__); printf("\n"); fails++; if (fails > 10) exit(1); } } while (0)
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// what the linked modules call from the rest of the firmware
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+static Uint32 nowMs;
+
+Uint32 timer0_fetchSystemMiliSecCount(void){
+	return nowMs;
+}
+
+void InitECan(void){
+}
+
+void diagRs232CanRecvMsg(Uint16 mbxNumber, Uint16* msg){
+	(void)mbxNumber;
+	(void)msg;
+}
+
+// limchkSendAvgValue() logs its progress
+void log_addToLog(enum LOG_EVENT_ID logEventID, Uint16 param_1){
+	(void)logEventID;
+	(void)param_1;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// the bus and the mSec, as the PC sees them
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+struct SEEN {
+	Uint32 ms;
+	Uint16 cob;
+	int pdo;						// 1 - 4
+	Uint16 w[4];
+};
+static struct SEEN seen[MAX_SEEN];
+static int nSeen;
+static Uint32 sdoFrames;
+static int busHeld;
+
+#define INBOX_SIZE 64
+static unsigned char inbox[INBOX_SIZE][8];
+static int inHead, inTail;
+
+static Uint16 node;
+
+static Uint16 mbxCob(int mbx){
+	return ((&ECanaMboxes.MBOX0)[mbx].MSGID.all >> 18) & 0x07FF;
+}
+
+static void busMs(void){
+	Uint32 mdl, mdh;
+	int mbx, n, i;
+	struct SEEN* s;
+
+	for (n = 0; (n < FRAMES_PER_MS) && !busHeld; n++){
+		if ((mbx = ecanSim_transmit(&mdl, &mdh)) < 0) break;
+		if (mbx < CAN_TX_PDO_MAILBOXES) {
+			CHECK(nSeen < MAX_SEEN, "too many PDOs");
+			s = &seen[nSeen++];
+			s->ms = nowMs;
+			s->pdo = mbx + 1;
+			s->cob = mbxCob(mbx);
+			s->w[0] = (Uint16)mdl;
+			s->w[1] = (Uint16)(mdl >> 16);
+			s->w[2] = (Uint16)mdh;
+			s->w[3] = (Uint16)(mdh >> 16);
+		} else {
+			CHECK(mbxCob(mbx) == 0x580u + node, "SDO reply from mailbox %d, COB ID %03lX",
+				mbx, (unsigned long)mbxCob(mbx));
+			for (i = 0; i < 4; i++){
+				inbox[inHead % INBOX_SIZE][i] = (mdl >> (8 * i)) & 0xFF;
+				inbox[inHead % INBOX_SIZE][i + 4] = (mdh >> (8 * i)) & 0xFF;
+			}
+			inHead++;
+			sdoFrames++;
+		}
+	}
+}
+
+// one mSec: timer0_miliSecTask(), the background loop, the bus
+static void tick(void){
+	int n;
+
+	nowMs++;
+	taskMgr_tickDelayWheel();
+	limChkStateMachine();
+	for (n = 0; n < PASSES_PER_MS; n++){
+		taskMgr_runBkgndTasks();
+	}
+	busMs();
+}
+
+static void run(Uint32 ms){
+	while (ms-- > 0){
+		tick();
+	}
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// SDO client, expedited
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+static int sdo(int cmd, Uint16 index, Uint16 subindex, Uint32 value, Uint32* reply){
+	unsigned char r[8];
+	Uint32 mdl, mdh;
+	int waits;
+
+	mdl = cmd | ((Uint32)index << 8) | ((Uint32)subindex << 24);
+	mdh = value;
+	ecanSim_receive(31, mdl, mdh);
+	sdoFrames++;
+	for (waits = 0; inTail == inHead; waits++){
+		CHECK(waits < 20, "no reply to %04X.%02X", index, subindex);
+		if (waits >= 20) return -1;
+		tick();
+	}
+	memcpy(r, inbox[inTail++ % INBOX_SIZE], 8);
+	CHECK((r[1] | (r[2] << 8)) == index && r[3] == subindex, "reply for %02X%02X.%02X, asked %04X.%02X",
+		r[2], r[1], r[3], index, subindex);
+	if (r[0] == 0x80) return r[4];				// abort, CANOPEN_STATUS
+	if (reply != NULL) *reply = r[4] | (r[5] << 8) | ((Uint32)r[6] << 16) | ((Uint32)r[7] << 24);
+	return CANOPEN_NO_ERR;
+}
+
+static int sdoWrite(Uint16 index, Uint16 subindex, Uint32 value){
+	return sdo(0x23, index, subindex, value, NULL);
+}
+
+static Uint32 sdoRead(Uint16 index, Uint16 subindex){
+	Uint32 v = 0xDEADBEEF;
+
+	CHECK(sdo(0x40, index, subindex, 0, &v) == CANOPEN_NO_ERR, "%04X.%02X read refused", index, subindex);
+	return v;
+}
+
+// 202B subindex of TPDO pdo (1 - 4): 1 COB ID, 2 mapping, 3 event timer, 4 inhibit
+#define TPDO_SUB(pdo, what) ((((pdo) - 1) << 2) + (what))
+#define COB_ID 1
+#define MAPPING 2
+#define EVENT_TIMER 3
+#define INHIBIT 4
+
+static void tpdoSet(int pdo, int what, Uint32 value){
+	CHECK(sdoWrite(CAN_INDEX_OF_LIM_CHK_TPDO, TPDO_SUB(pdo, what), value) == CANOPEN_NO_ERR,
+		"202B.%02X = %lX refused", TPDO_SUB(pdo, what), (unsigned long)value);
+}
+
+static void tpdoOff(int pdo){
+	tpdoSet(pdo, COB_ID, 0x80000000L | (0x80 + (pdo << 8) + node));
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// what the PC saw
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+static int countSeen(int from, int pdo){
+	int i, n = 0;
+
+	for (i = from; i < nSeen; i++){
+		if (seen[i].pdo == pdo) n++;
+	}
+	return n;
+}
+
+static struct SEEN* nextSeen(int* from, int pdo){
+	for (; *from < nSeen; (*from)++){
+		if (seen[*from].pdo == pdo) return &seen[(*from)++];
+	}
+	return NULL;
+}
+
+static void powerUp(void){
+	int i;
+
+	ecanSim_reset();
+	GpioDataRegs.GPBDAT.all = rand() & 0x00F0;
+	taskMgr_init();
+	canC_initComm();
+	canC_store_int_vectors_in_PIE();
+	canC_enable_interrupt();
+	node = canC_readCanAddrDipSwitches();
+	memset(limitCheckParams, 0, sizeof limitCheckParams);
+	nowMs = 100000;
+	limchkInit();
+	for (i = 0; i < 8; i++){
+		limitCheckParams[i].ioType = (i < 4) ? IO_TYPE_ANLG_IN_1234 : IO_TYPE_ANLG_IN_5678;
+		limitCheckParams[i].measValue = 0x8000;
+	}
+	nSeen = 0;
+	inHead = inTail = 0;
+	sdoFrames = 0;
+	busHeld = 0;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// 1. defaults
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+static void defaults(void){
+	int pdo;
+	Uint32 cob;
+
+	powerUp();
+	run(2000);
+	CHECK(nSeen == 0, "defaults: %d PDOs with all of them off", nSeen);
+	for (pdo = 1; pdo <= 4; pdo++){
+		cob = 0x80 + (pdo << 8) + node;
+		CHECK(sdoRead(CAN_INDEX_OF_LIM_CHK_TPDO, TPDO_SUB(pdo, COB_ID)) == (0x80000000L | cob), "defaults: TPDO%d COB ID %08lX",
+			pdo, (unsigned long)sdoRead(CAN_INDEX_OF_LIM_CHK_TPDO, TPDO_SUB(pdo, COB_ID)));
+		CHECK(mbxCob(pdo - 1) == cob, "defaults: mailbox %d COB ID %03lX", pdo - 1,
+			(unsigned long)mbxCob(pdo - 1));
+	}
+
+	CHECK(sdoWrite(CAN_INDEX_OF_LIM_CHK_TPDO, 1, 0) == CANOPEN_LIMCHK_003_ERR, "COB ID 0 taken");
+	CHECK(sdoWrite(CAN_INDEX_OF_LIM_CHK_TPDO, 1, 0x800) == CANOPEN_LIMCHK_003_ERR, "COB ID 800 taken");
+	CHECK(sdoWrite(CAN_INDEX_OF_LIM_CHK_TPDO, 1, 0x20000185L) == CANOPEN_LIMCHK_003_ERR, "extended COB ID taken");
+	CHECK(sdoWrite(CAN_INDEX_OF_LIM_CHK_TPDO, 1, 0x40000185L) == CANOPEN_LIMCHK_003_ERR, "bit 30 taken");
+	CHECK(sdoWrite(CAN_INDEX_OF_LIM_CHK_TPDO, 5, 0x580 + node) == CANOPEN_LIMCHK_003_ERR, "our SDO reply COB ID taken");
+	CHECK(sdoWrite(CAN_INDEX_OF_LIM_CHK_TPDO, 9, 0x600 + node) == CANOPEN_LIMCHK_003_ERR, "our SDO request COB ID taken");
+	CHECK(sdoWrite(CAN_INDEX_OF_LIM_CHK_TPDO, 0x11, 0x185) != CANOPEN_NO_ERR, "202B.11 taken");
+	run(100);
+	CHECK(nSeen == 0, "defaults: %d PDOs after refused COB IDs", nSeen);
+
+	tpdoSet(3, COB_ID, 0x3A0 + node);
+	CHECK(mbxCob(2) == 0x3A0u + node, "TPDO3 COB ID not in mailbox 2");
+	run(2);
+	CHECK((nSeen == 1) && (seen[0].pdo == 3) && (seen[0].cob == 0x3A0 + node), "TPDO3 not sent at once on %03X",
+		0x3A0 + node);
+	tpdoOff(3);
+	run(500);
+	CHECK(nSeen == 1, "TPDO3 sent %d more after it was turned off", nSeen - 1);
+	printf("defaults: all TPDOs off, COB IDs checked\n");
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// 2. status
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+static Uint16 expectStatus(int word){
+	Uint16 w = 0;
+	int i;
+
+	for (i = 0; i < 8; i++){
+		if (word < 2) {
+			if ((i >> 2) == word) w |= (limitCheckParams[i].testStatus & 0xF) << ((i & 3) << 2);
+		} else {
+			if (limitCheckParams[i].enableTest == LIMCHK_TEST_ENABLED) w |= 1 << i;
+			if (limitCheckParams[i].comparisonResult != LCC_WITHIN_INNER_LIMITS) w |= 0x100 << i;
+		}
+	}
+	return w;
+}
+
+static void checkStatus(const char* what, const struct SEEN* s){
+	CHECK((s->w[0] == expectStatus(0)) && (s->w[1] == expectStatus(1)) && (s->w[2] == expectStatus(2))
+		&& (s->w[3] == (Uint16)s->ms), "%s: status %04X %04X %04X %04X at %lu, expected %04X %04X %04X %04X", what,
+		s->w[0], s->w[1], s->w[2], s->w[3], (unsigned long)s->ms, expectStatus(0), expectStatus(1), expectStatus(2), (Uint16)s->ms);
+}
+
+static void status(void){
+	struct SEEN* s;
+	Uint32 t, last;
+	int from, n, k;
+
+	powerUp();
+	tpdoSet(1, COB_ID, 0x180 + node);
+	from = 0;
+	run(1);
+	s = nextSeen(&from, 1);
+	CHECK((s != NULL) && (s->cob == 0x180 + node), "status: not sent at once");
+	if (s != NULL) checkStatus("at once", s);
+
+	// the PC enables a test on channel 3: TESTING, enable bit
+	t = nowMs;
+	CHECK(sdoWrite(CAN_INDEX_OF_LIM_CHK_CHANNEL_1 + 2, 1, LIMCHK_TEST_ENABLED) == CANOPEN_NO_ERR, "enable refused");
+	run(12);
+	s = nextSeen(&from, 1);
+	CHECK((s != NULL) && (s->ms - t <= 11) && ((s->w[0] >> 8) == TESTING) && (s->w[2] & 0x04),
+		"status: channel 3 enabled at %lu, seen %s", (unsigned long)t, s ? "wrong" : "never");
+	if (s != NULL) checkStatus("channel 3 enabled", s);
+	CHECK(nextSeen(&from, 1) == NULL, "status: sent twice for one change");
+
+	// changes faster than the inhibit time: spaced by it, the last one out
+	last = s ? s->ms : nowMs;
+	for (k = 0; k < 40; k++){
+		limitCheckParams[rand() % 8].comparisonResult = rand() % 5;
+		limitCheckParams[rand() % 8].testStatus = (rand() % 2) ? LIMITS_FAILED : TESTING;
+		run(1 + rand() % 4);
+	}
+	run(20);
+	n = 0;
+	while ((s = nextSeen(&from, 1)) != NULL) {
+		CHECK(s->ms - last >= 10, "status: %lu mSec after the last one, inhibit 10", (unsigned long)(s->ms - last));
+		last = s->ms;
+		n++;
+	}
+	CHECK(n >= 8, "status: only %d sent for 40 changes over %lu mSec", n, (unsigned long)(nowMs - t));
+	checkStatus("after the changes", &seen[nSeen - 1]);
+
+	// no change: every 1000 mSec, the mSec stamp changing each time
+	run(3500);
+	n = 0;
+	while ((s = nextSeen(&from, 1)) != NULL) {
+		CHECK(s->ms - last == 1000, "status: %lu mSec apart with no change, event timer 1000", (unsigned long)(s->ms - last));
+		checkStatus("event timer", s);
+		last = s->ms;
+		n++;
+	}
+	CHECK(n == 3, "status: %d sent in 3500 mSec", n);
+
+	// inhibit 50, event timer 0: on change only, 50 apart
+	tpdoSet(1, INHIBIT, 50);
+	tpdoSet(1, EVENT_TIMER, 0);
+	run(5000);
+	from = nSeen;
+	for (k = 0; k < 30; k++){
+		limitCheckParams[rand() % 8].comparisonResult = rand() % 5;
+		run(1 + rand() % 20);
+	}
+	run(60);
+	last = 0;
+	n = 0;
+	while ((s = nextSeen(&from, 1)) != NULL) {
+		CHECK((last == 0) || (s->ms - last >= 50), "status: %lu mSec apart, inhibit 50", (unsigned long)(s->ms - last));
+		last = s->ms;
+		n++;
+	}
+	CHECK(n >= 4, "status: %d sent for 30 changes", n);
+	checkStatus("inhibit 50", &seen[nSeen - 1]);
+	run(5000);
+	CHECK(countSeen(from, 1) == 0, "status: sent with event timer 0 and no change");
+	from = nSeen;
+	tpdoOff(1);
+	tpdoSet(1, COB_ID, 0x180 + node);
+	run(1);
+	CHECK(countSeen(from, 1) == 1, "status: not sent at once when turned on with event timer 0");
+	printf("status: at once, on change no sooner than the inhibit time, on the event timer\n");
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// 3. measurements
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+static void checkMeas(const char* what, const struct SEEN* s, int first){
+	int i;
+
+	for (i = 0; i < 4; i++){
+		CHECK(s->w[i] == limchkConvertNativeToClassic(limitCheckParams[first + i].measValue, limitCheckParams[first + i].ioType),
+			"%s: word %d %04X, channel %d measValue %04lX", what, i, s->w[i], first + i + 1,
+			(unsigned long)limitCheckParams[first + i].measValue);
+	}
+}
+
+static void setMeas(void){
+	int i;
+
+	for (i = 0; i < 8; i++){
+		limitCheckParams[i].measValue = rand() & 0xFFFF;
+	}
+}
+
+static void measurements(void){
+	struct SEEN* s;
+	Uint32 last2 = 0, last3 = 0;
+	int from, k;
+
+	powerUp();
+	setMeas();
+	tpdoSet(2, COB_ID, 0x280 + node);
+	tpdoSet(3, COB_ID, 0x380 + node);
+	for (k = 0; k < 30; k++){
+		run(1 + rand() % 60);
+		setMeas();			// periodic only: no sooner for a change
+	}
+	for (k = 0; k < nSeen; k++){
+		s = &seen[k];
+		if (s->pdo == 2) {
+			CHECK((last2 == 0) || (s->ms - last2 == 100), "TPDO2 %lu mSec apart, event timer 100", (unsigned long)(s->ms - last2));
+			last2 = s->ms;
+		} else if (s->pdo == 3) {
+			CHECK((last3 == 0) || (s->ms - last3 == 100), "TPDO3 %lu mSec apart, event timer 100", (unsigned long)(s->ms - last3));
+			last3 = s->ms;
+		} else {
+			CHECK(0, "TPDO%d sent", s->pdo);
+		}
+	}
+	// what they carry, the ANLG_IN_5678 conversion included
+	from = nSeen;
+	setMeas();
+	run(100);
+	s = nextSeen(&from, 2);
+	CHECK(s != NULL, "TPDO2 not sent in 100 mSec");
+	if (s != NULL) checkMeas("TPDO2", s, 0);
+	from = nSeen - 2;
+	s = nextSeen(&from, 3);
+	CHECK(s != NULL, "TPDO3 not sent in 100 mSec");
+	if (s != NULL) checkMeas("TPDO3", s, 4);
+
+	// TPDO2 mapped to channels 5 - 8, on change too
+	tpdoSet(2, MAPPING, LCPDO_MAP_MEAS_5_8);
+	run(150);
+	from = nSeen;
+	limitCheckParams[6].measValue ^= 0x1000;
+	run(11);
+	s = nextSeen(&from, 2);
+	CHECK(s != NULL, "TPDO2 not sent on change");
+	if (s != NULL) checkMeas("TPDO2 channels 5 - 8", s, 4);
+	run(20);
+	from = nSeen;
+	limitCheckParams[7].measValue ^= 0x1000;
+	run(1);
+	s = nextSeen(&from, 2);
+	CHECK(s != NULL, "TPDO2 not sent on a change to its last word");
+	if (s != NULL) checkMeas("TPDO2 channel 8", s, 4);
+	printf("measurements: every 100 mSec to the mSec, channels by mapping, periodic only or on change\n");
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// 4. statistics
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+static void checkStats(const struct SEEN* s, int ch){
+	struct LIMIT_CHECK_PARAMETERS* p = &limitCheckParams[ch];
+	Uint16 min = limchkConvertNativeToClassic(p->minValue, p->ioType);
+	Uint16 max = limchkConvertNativeToClassic(p->maxValue, p->ioType);
+	Uint16 avg = limchkConvertNativeToClassic(p->avgValue, p->ioType);
+
+	if (p->ioType == IO_TYPE_ANLG_IN_5678) {
+		Uint16 t = min;
+		min = max;
+		max = t;
+	}
+	CHECK((s->w[0] == (ch | (p->testStatus << 8))) && (s->w[1] == min) && (s->w[2] == max) && (s->w[3] == avg),
+		"stats: %04X %04X %04X %04X, channel %d expected %04X %04X %04X %04X", s->w[0], s->w[1], s->w[2], s->w[3], ch + 1,
+		ch | (p->testStatus << 8), min, max, avg);
+}
+
+static void statistics(void){
+	struct SEEN* s;
+	int from, i, k;
+
+	powerUp();
+	for (i = 0; i < 8; i++){
+		limitCheckParams[i].minValue = 0x7000 + rand() % 0x1000;
+		limitCheckParams[i].maxValue = 0x9000 + rand() % 0x1000;
+		limitCheckParams[i].avgValue = 0x8000 + rand() % 0x800;
+		limitCheckParams[i].windowsDone = 1;
+		limitCheckParams[i].testStatus = rand() % 2;
+	}
+	tpdoSet(4, EVENT_TIMER, 12);
+	tpdoSet(4, COB_ID, 0x480 + node);
+	run(12 * 24);
+	from = 0;
+	for (k = 0; (s = nextSeen(&from, 4)) != NULL; k++){
+		CHECK((s->w[0] & 0xFF) == k % 8, "stats: turn %d was channel %d", k, (s->w[0] & 0xFF) + 1);
+		checkStats(s, s->w[0] & 0xFF);
+	}
+	CHECK(k >= 24, "stats: %d sent in %d mSec", k, 12 * 24);
+
+	tpdoSet(4, MAPPING, LCPDO_MAP_STATS | LCPDO_PERIODIC_ONLY | (5 << 8));
+	from = nSeen;
+	run(120);
+	for (k = 0; (s = nextSeen(&from, 4)) != NULL; k++){
+		CHECK((s->w[0] & 0xFF) == 5, "stats: channel %d, mapped to 6", (s->w[0] & 0xFF) + 1);
+		checkStats(s, 5);
+	}
+	CHECK(k >= 9, "stats: %d sent for channel 6", k);
+	printf("statistics: taking turns through the 8 channels, or one, min/max swapped for 5678\n");
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// 5. bus held
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+static void busHeldByOthers(void){
+	struct SEEN* s;
+	Uint32 released, v;
+	int from, k;
+
+	powerUp();
+	setMeas();
+	tpdoSet(2, EVENT_TIMER, 5);
+	tpdoSet(2, INHIBIT, 0);
+	tpdoSet(2, COB_ID, 0x280 + node);
+	for (k = 0; k < 20; k++){
+		run(1 + rand() % 10);
+		from = nSeen;
+		busHeld = 1;
+		run(11 + rand() % 25);	// past the next event timer mSec, whenever the frame was loaded
+		CHECK(ECanaRegs.CANTRS.all & 0x2, "bus held: TPDO2 mailbox idle");
+		limitCheckParams[rand() % 4].measValue = rand() & 0xFFFF;
+		busHeld = 0;
+		released = nowMs;
+		run(1);					// the frame loaded before the bus was held
+		run(1);					// and a new one, loaded the mSec the mailbox was free
+		CHECK(countSeen(from, 2) == 2, "bus held: %d frames when it was released", countSeen(from, 2));
+		s = nextSeen(&from, 2);
+		s = nextSeen(&from, 2);
+		CHECK((s != NULL) && (s->ms == released + 2), "bus held: latest data not sent the next mSec");
+		if (s != NULL) checkMeas("bus released", s, 0);
+	}
+
+	// SDO replies in order around a stream of PDOs
+	tpdoSet(2, EVENT_TIMER, 1);
+	tpdoSet(1, EVENT_TIMER, 2);
+	tpdoSet(1, COB_ID, 0x180 + node);
+	for (k = 0; k < 200; k++){
+		limitCheckParams[k % 8].allowedFails = k;
+		v = sdoRead(CAN_INDEX_OF_LIM_CHK_CHANNEL_1 + k % 8, 6);
+		CHECK((v & 0xFFFF) == (Uint32)k, "SDO read of channel %d allowedFails %lu, expected %d", k % 8 + 1, (unsigned long)(v & 0xFFFF), k);
+		if (rand() % 4 == 0) {
+			busHeld = 1;
+			run(rand() % 5);
+			busHeld = 0;
+		}
+	}
+	CHECK(canC_txQueueFullCount == 0, "%lu SDO frames dropped", (unsigned long)canC_txQueueFullCount);
+	printf("bus held: no frame loaded twice, the latest data the mSec after; SDO replies in order\n");
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// 6. 8 channels at 10 Hz
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+#define WATCH_MS 20000
+
+// a channel's test status changes now and then, and the PC takes note of
+// how long each change took to reach it, by whichever means
+static Uint32 changeAt[8], changes, latencySum, latencyMax;
+static Uint16 pcStatus[8];
+
+static void maybeChange(void){
+	int ch;
+
+	if (rand() % 150 == 0) {
+		ch = rand() % 8;
+		if (changeAt[ch] != 0) return;		// the last change not seen yet
+		limitCheckParams[ch].testStatus = (limitCheckParams[ch].testStatus == TESTING) ? LIMITS_FAILED : TESTING;
+		changeAt[ch] = nowMs;
+	}
+}
+
+static void pcSees(int ch, Uint16 st){
+	if ((st != pcStatus[ch]) && (changeAt[ch] != 0)) {
+		latencySum += nowMs - changeAt[ch];
+		if (nowMs - changeAt[ch] > latencyMax) latencyMax = nowMs - changeAt[ch];
+		changes++;
+		changeAt[ch] = 0;
+	}
+	pcStatus[ch] = st;
+}
+
+static void watchStart(void){
+	int ch;
+
+	powerUp();
+	for (ch = 0; ch < 8; ch++){
+		limitCheckParams[ch].testStatus = TESTING;
+		limitCheckParams[ch].sumCount = 1;
+		pcStatus[ch] = TESTING;
+		changeAt[ch] = 0;
+	}
+	changes = latencySum = latencyMax = 0;
+}
+
+static void watch(void){
+	Uint32 end, nextPoll, frames;
+	double sdoRate, pdoRate, sdoLatency, pdoLatency;
+	Uint32 sdoLatencyMax;
+	int ch, from;
+	struct SEEN* s;
+
+	// SDO: 202x.09 (status and measValue), .07 (min/max), .08 (avg) for
+	// each channel every 100 mSec
+	watchStart();
+	end = nowMs + WATCH_MS;
+	nextPoll = nowMs;
+	while (nowMs < end){
+		if (nowMs >= nextPoll) {
+			nextPoll += 100;
+			for (ch = 0; ch < 8; ch++){
+				pcSees(ch, sdoRead(CAN_INDEX_OF_LIM_CHK_CHANNEL_1 + ch, 9) & 0xFFFF);
+				sdoRead(CAN_INDEX_OF_LIM_CHK_CHANNEL_1 + ch, 7);
+				sdoRead(CAN_INDEX_OF_LIM_CHK_CHANNEL_1 + ch, 8);
+				maybeChange();
+			}
+		}
+		tick();
+		maybeChange();
+	}
+	sdoRate = sdoFrames * 1000.0 / WATCH_MS;
+	sdoLatency = changes ? (double)latencySum / changes : 0;
+	sdoLatencyMax = latencyMax;
+	CHECK(changes > 50, "SDO watch: only %lu changes seen", (unsigned long)changes);
+
+	// PDO: status on change, measurements every 100 mSec, statistics taking
+	// turns every 12 mSec (each channel every 96)
+	watchStart();
+	tpdoSet(4, EVENT_TIMER, 12);
+	for (ch = 1; ch <= 4; ch++){
+		tpdoSet(ch, COB_ID, 0x80 + (ch << 8) + node);
+	}
+	sdoFrames = 0;
+	from = nSeen;
+	end = nowMs + WATCH_MS;
+	while (nowMs < end){
+		tick();
+		maybeChange();
+		while ((s = nextSeen(&from, 1)) != NULL) {
+			for (ch = 0; ch < 8; ch++){
+				pcSees(ch, (s->w[ch >> 2] >> ((ch & 3) << 2)) & 0xF);
+			}
+		}
+	}
+	frames = 0;
+	for (from = 0; from < nSeen; from++){
+		if (seen[from].ms > end - WATCH_MS) frames++;
+	}
+	pdoRate = frames * 1000.0 / WATCH_MS;
+	pdoLatency = changes ? (double)latencySum / changes : 0;
+	CHECK(changes > 50, "PDO watch: only %lu changes seen", (unsigned long)changes);
+	CHECK(sdoFrames == 0, "PDO watch: %lu SDO frames", (unsigned long)sdoFrames);
+	CHECK(pdoRate < sdoRate / 4, "PDO: %.0f frames/Sec, SDO polling %.0f", pdoRate, sdoRate);
+	CHECK(latencyMax <= 11, "PDO: status change took up to %lu mSec to reach the PC", (unsigned long)latencyMax);
+	CHECK(pdoLatency < sdoLatency / 4, "PDO: status change latency %.1f mSec, SDO polling %.1f", pdoLatency, sdoLatency);
+	printf("8 channels at 10 Hz: SDO polling %.0f frames/Sec, status change seen after %.1f mSec (at most %lu);\n"
+		"                     PDO %.0f frames/Sec, status change seen after %.1f mSec (at most %lu)\n",
+		sdoRate, sdoLatency, (unsigned long)sdoLatencyMax, pdoRate, pdoLatency, (unsigned long)latencyMax);
+}
+
+int main(void){
+	srand(17);
+	defaults();
+	status();
+	measurements();
+	statistics();
+	busHeldByOthers();
+	watch();
+	printf(fails ? "FAIL (%d)\n" : "PASS\n", fails);
+	return fails != 0;
+}
@@ -0,0 +1,205 @@
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+//
+//     LimChkStats.c
+//
+// Host test of the running statistics limChkBackgroundMinMaxAvg() keeps
+// for each limit-check channel, every 200 uSec sample, with no division:
+// window mean, EMA and variance over 2^statShift samples, against the
+// same statistics computed in double precision from the same samples.
+//  1. the reference: quiet and noisy analog inputs, a ramp, a window of 1
+//     sample, 18-bit frequency periods; the window mean and variance within
+//     1 count (count^2) of the reference every window, the EMA within 2
+//     counts of a double-precision EMA
+//  2. the long test the old sum and count got wrong: full-scale samples
+//     over many 4096-sample windows, the mean exact
+//  3. the noise check: limChkBackgroundMinMaxAvg() returns true at the end
+//     of the first window whose variance is above varLimit, never with a
+//     varLimit of 0
+//  4. avgValue before the 1st window completes is the EMA; statShift
+//     takes effect when the test starts; 202x.0E refuses more than
+//     LC_STAT_MAX_SHIFT
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "DSP281x_Device.h"
+#include "stdbool.h"
+#include "CanOpen.H"
+#include "LimitChk.H"
+#include "Log.H"
+
+static int fails;
+#define CHECK(c, ...) do { if (!(c)) { printf("FAIL %s:%d ", __FILE__, __LINE__); \
+	printf(__VA_ARGS__); printf("\n"); fails++; if (fails > 10) exit(1); } } while (0)
+
+// limChkBackgroundComputeAvg() logs its progress
+void log_addToLog(enum LOG_EVENT_ID logEventID, Uint16 param_1){
+	(void)logEventID;
+	(void)param_1;
+}
+
+static double gauss(void){
+	double u = (rand() + 1.0) / (RAND_MAX + 2.0);
+	double v = (rand() + 1.0) / (RAND_MAX + 2.0);
+
+	return sqrt(-2 * log(u)) * cos(2 * M_PI * v);
+}
+
+static void start(struct LIMIT_CHECK_PARAMETERS* p, enum IO_TYPE ioType, Uint16 shift){
+	memset(p, 0, sizeof *p);
+	p->ioType = ioType;
+	p->statShift = shift;
+	limChkBackgroundMinMaxAvgInit(p);
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// 1. the reference
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+#define MAX_WINDOW 4096
+
+static void reference(const char* name, enum IO_TYPE ioType, double mean, double sigma, double ramp,
+		Uint16 shift, int windows){
+	static double xs[MAX_WINDOW];
+	struct LIMIT_CHECK_PARAMETERS p;
+	int n = 1 << shift;
+	double ema = 0, m, var, err;
+	double worstMean = 0, worstVar = 0, worstEma = 0;
+	long v;
+	int w, i;
+
+	start(&p, ioType, shift);
+	for (w = 0; w < windows; w++){
+		for (i = 0; i < n; i++){
+			v = lround(mean + sigma * gauss() + ramp * (w * n + i));
+			if (v < 0) v = 0;
+			if ((ioType != IO_TYPE_FREQ) && (v > 0xFFFF)) v = 0xFFFF;
+			xs[i] = v;
+			ema = ((w == 0) && (i == 0)) ? v : ema + (v - ema) / n;
+			p.measValue = (Uint32)v;
+			CHECK(!limChkBackgroundMinMaxAvg(&p), "%s: noisy with no varLimit", name);
+			// the EMA starts from the 1st sample, give it 4 time constants
+			if ((w * n + i >= 4 * n) && ((err = fabs((double)p.emaValue - ema)) > worstEma)) worstEma = err;
+		}
+		for (i = 0, m = 0; i < n; i++){
+			m += xs[i];
+		}
+		m /= n;
+		for (i = 0, var = 0; i < n; i++){
+			var += (xs[i] - m) * (xs[i] - m);
+		}
+		var /= n;
+		if ((err = fabs((double)p.avgValue - m)) > worstMean) worstMean = err;
+		if ((err = fabs((double)p.varValue - var)) > worstVar) worstVar = err;
+		CHECK(p.windowsDone == w + 1, "%s: windowsDone %u after %d windows", name, p.windowsDone, w + 1);
+	}
+	CHECK(worstMean < 1.0, "%s: mean off by %.3f", name, worstMean);
+	CHECK(worstVar < 1.0 + 1e-6 * sigma * sigma, "%s: variance off by %.3f", name, worstVar);
+	CHECK(worstEma < 2.0 + 0.01 * sigma, "%s: EMA off by %.3f", name, worstEma);
+	printf("%-26s window %4d: mean off by %.3f, variance by %.3f, EMA by %.3f\n", name, n, worstMean, worstVar, worstEma);
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// 2. a long test at full scale
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+static void fullScale(void){
+	struct LIMIT_CHECK_PARAMETERS p;
+	long i;
+
+	start(&p, IO_TYPE_ANLG_IN_1234, LC_STAT_MAX_SHIFT);
+	for (i = 0; i < 64L << LC_STAT_MAX_SHIFT; i++){
+		p.measValue = 0xFFFF;
+		limChkBackgroundMinMaxAvg(&p);
+	}
+	limChkBackgroundComputeAvg(&p);
+	CHECK((p.avgValue == 0xFFFF) && (p.emaValue == 0xFFFF) && (p.varValue == 0), "full scale analog: mean %lX, EMA %lX, variance %lu",
+		(unsigned long)p.avgValue, (unsigned long)p.emaValue, (unsigned long)p.varValue);
+
+	start(&p, IO_TYPE_FREQ, LC_STAT_MAX_SHIFT);
+	for (i = 0; i < 16L << LC_STAT_MAX_SHIFT; i++){
+		p.measValue = 0x00300000L;		// clamped to LC_STAT_MAX_SAMPLE
+		limChkBackgroundMinMaxAvg(&p);
+	}
+	CHECK((p.avgValue == LC_STAT_MAX_SAMPLE) && (p.emaValue == LC_STAT_MAX_SAMPLE), "frequency above 20 bits: mean %lX, EMA %lX",
+		(unsigned long)p.avgValue, (unsigned long)p.emaValue);
+	printf("full scale: 64 windows of 4096 at 0xFFFF, mean exact\n");
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// 3. the noise check
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+static void noise(void){
+	struct LIMIT_CHECK_PARAMETERS p;
+	int i, tripped = -1;
+
+	// windows of 16: +-2 (variance 4) for 2 windows, then +-20 (variance 400)
+	start(&p, IO_TYPE_ANLG_IN_1234, 4);
+	p.varLimit = 100;
+	for (i = 0; i < 64; i++){
+		p.measValue = 0x8000 + ((i & 1) ? 1 : -1) * ((i < 32) ? 2 : 20);
+		if (limChkBackgroundMinMaxAvg(&p) && (tripped < 0)) tripped = i;
+	}
+	CHECK(tripped == 47, "noise: tripped at sample %d, not at the end of the 3rd window (47)", tripped);
+	CHECK(p.varValue == 400, "noise: variance %lu, expected 400", (unsigned long)p.varValue);
+
+	p.varLimit = 400;
+	for (i = 0; i < 16; i++){
+		p.measValue = 0x8000 + ((i & 1) ? 20 : -20);
+		CHECK(!limChkBackgroundMinMaxAvg(&p), "noise: tripped at variance %lu, varLimit 400", (unsigned long)p.varValue);
+	}
+	printf("noise: tripped at the end of the first window over varLimit\n");
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// 4. before the 1st window, statShift
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+static void statShift(void){
+	struct LIMIT_CHECK_PARAMETERS p;
+	struct CAN_COMMAND cmd = {&p.statShift, TYP_UINT16, NULL, NULL};
+	Uint16 data[4];
+	int i;
+
+	start(&p, IO_TYPE_ANLG_IN_1234, 12);
+	for (i = 0; i < 100; i++){
+		p.measValue = 1234;
+		limChkBackgroundMinMaxAvg(&p);
+	}
+	limChkBackgroundComputeAvg(&p);
+	CHECK((p.avgValue == 1234) && (p.windowsDone == 0), "avg before the 1st window %lu, expected the EMA, 1234", (unsigned long)p.avgValue);
+
+	// a new statShift waits for the next test
+	data[2] = 3;
+	CHECK(limchkRecvStatShift(&cmd, data) == CANOPEN_NO_ERR, "202x.0E = 3 refused");
+	for (i = 0; i < 8; i++){
+		limChkBackgroundMinMaxAvg(&p);
+	}
+	CHECK(p.windowsDone == 0, "statShift took effect during a test");
+	limChkBackgroundMinMaxAvgInit(&p);
+	for (i = 0; i < 8; i++){
+		limChkBackgroundMinMaxAvg(&p);
+	}
+	CHECK(p.windowsDone == 1, "statShift 3: %u windows after 8 samples", p.windowsDone);
+
+	data[2] = LC_STAT_MAX_SHIFT + 1;
+	CHECK(limchkRecvStatShift(&cmd, data) == CANOPEN_LIMCHK_004_ERR, "202x.0E = %d taken", LC_STAT_MAX_SHIFT + 1);
+	CHECK(p.statShift == 3, "statShift %u after a refused one", p.statShift);
+	printf("statShift: at the next test start, at most %d\n", LC_STAT_MAX_SHIFT);
+}
+
+int main(void){
+	srand(18);
+	reference("analog quiet, sigma 0.5", IO_TYPE_ANLG_IN_1234, 0x8000, 0.5, 0, 12, 6);
+	reference("analog, sigma 3", IO_TYPE_ANLG_IN_1234, 0x9123, 3, 0, 10, 10);
+	reference("analog 5678, sigma 50", IO_TYPE_ANLG_IN_5678, 0x4000, 50, 0, 8, 20);
+	reference("analog, sigma 2000", IO_TYPE_ANLG_IN_1234, 0x8000, 2000, 0, 12, 6);
+	reference("analog ramp", IO_TYPE_ANLG_IN_1234, 0x1000, 5, 0.05, 6, 40);
+	reference("analog, window of 1", IO_TYPE_ANLG_IN_1234, 0x8000, 10, 0, 0, 50);
+	reference("frequency 200000, sigma 40", IO_TYPE_FREQ, 200000, 40, 0, 12, 6);
+	fullScale();
+	noise();
+	statShift();
+	printf(fails ? "FAIL (%d)\n" : "PASS\n", fails);
+	return fails != 0;
+}
@@ -0,0 +1,377 @@
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+//
+//     McsStream.c
+//
+// Host test for the streamed MCS download: mcsParseStream() in McsParse.c
+// and download algorithm 2 in FlashRW.C (0x204C.04 = 2, data through
+// 0x204C.22), against the fixture data/FpgaSample.mcs -- 4106 bytes in
+// 16-byte records with CR/LF, starting at 0xFE00 and running on past an
+// address extension record -- and data/FpgaSample.bin, the same bytes
+// decoded by objcopy -I ihex -O binary.
+//  1. parser: the fixture in random chunks, one character at a time, and
+//     without CR/LF; every record must parse as mcsParseReceivedData()
+//     parses it on its own, and the data must be FpgaSample.bin byte for
+//     byte.  Then broken records: bad checksum, non-hex character, record
+//     cut short, too long, junk between records.
+//  2. download: the PC side polls 0x204C.05 for room and sends 1 - 128
+//     characters at a time, the background tasks running at random in
+//     between.  The flash (SpiFlashSim.c) must hold FpgaSample.bin byte
+//     for byte at the offset given, page aligned or not, and be erased
+//     everywhere else; at page aligned offsets the image must equal the
+//     one record-at-a-time algorithm 0 writes, with fewer page programs.
+//  3. a bad record part way through the download stops it with the parse
+//     error; the full pages before it are in flash, nothing else.
+//
+//     McsStream [fixture.mcs fixture.bin]
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "DSP281x_Device.h"
+#include "stdbool.h"
+#include "CanOpen.H"
+#include "FlashRW.H"
+#include "McsParse.H"
+#include "TaskMgr.h"
+#include "SpiFlashSim.h"
+
+// FlashRW.C internals
+extern Uint16 mcsFileRecvStatus;
+extern Uint16 mcsFileRecvError;
+extern Uint16 mcsFileRecvAddrExtension;
+
+#define MAX_FIXTURE 0x10000L
+#define DOWNLOADS 40
+
+static int fails;
+#define CHECK(c, ...) do { if (!(c)) { printf("FAIL %s:%d ", __FILE__, __LINE__); \
+	printf(__VA_ARGS__); printf("\n"); fails++; if (fails > 10) exit(1); } } while (0)
+
+static char mcs[MAX_FIXTURE];
+static long mcsLen;
+static unsigned char bin[MAX_FIXTURE];
+static long binLen;
+
+static long readFile(const char* name, void* buf, long max){
+	FILE* f = fopen(name, "rb");
+	long n;
+
+	if (f == NULL) {
+		printf("FAIL can't open %s\n", name);
+		exit(1);
+	}
+	n = (long)fread(buf, 1, max, f);
+	fclose(f);
+	return n;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// 1. parser
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+// the fixture without its CR/LF
+static void stripLineEnds(const char* in, long len, char* out, long* outLen){
+	long i;
+
+	*outLen = 0;
+	for (i = 0; i < len; i++){
+		if ((in[i] != '\r') && (in[i] != '\n')) out[(*outLen)++] = in[i];
+	}
+}
+
+// where the record starting at text[start] ends (the next ':' or the end)
+static long recordEnd(const char* text, long len, long start){
+	long end = start + 1;
+
+	while ((end < len) && (text[end] != ':')) end++;
+	while ((end > start) && ((text[end - 1] == '\r') || (text[end - 1] == '\n'))) end--;
+	return end;
+}
+
+// feed text through mcsParseStream() in chunks of 1 - maxChunk characters,
+// checking each record against mcsParseReceivedData(), collecting data
+static void parseAll(const char* what, const char* text, long len, int maxChunk){
+	struct MCS_STREAM_PARSER parser;
+	unsigned char out[MAX_FIXTURE];
+	long outLen = 0, pos = 0, recStart = -1, records = 0;
+	Uint16 chunk, used, status, i;
+	Uint16 byteCount, recType, addr, numWords, words[16];
+	Uint16 oldStatus;
+	char* p;
+
+	mcsParseStreamInit(&parser);
+	while (pos < len){
+		chunk = 1 + rand() % maxChunk;
+		if (chunk > len - pos) chunk = len - pos;
+		p = (char*)text + pos;
+		while (chunk > 0){
+			status = mcsParseStream(&parser, p, chunk, &used);
+			for (i = 0; i < used; i++){
+				if (p[i] == ':') recStart = (p - text) + i;
+			}
+			p += used;
+			chunk -= used;
+			if (status == MCS_PARSE_NO_ERR) continue;
+			records++;
+			oldStatus = mcsParseReceivedData((char*)text + recStart, recordEnd(text, len, recStart) - recStart,
+				&byteCount, &recType, &addr, &numWords, words);
+			CHECK(status == oldStatus, "%s: record at %ld: status %u, mcsParseReceivedData says %u", what, recStart, status, oldStatus);
+			CHECK((parser.byteCount == byteCount) && (parser.recType == recType) && (parser.addr == addr),
+				"%s: record at %ld: count %u type %u addr %04X, mcsParseReceivedData %u %u %04X", what, recStart,
+				parser.byteCount, parser.recType, parser.addr, byteCount, recType, addr);
+			if (status == MCS_PARSE_RECEIVED_SOME_DATA) {
+				CHECK(parser.numDataBytes == byteCount, "%s: record at %ld: %u data bytes", what, recStart, parser.numDataBytes);
+				for (i = 0; i < parser.numDataBytes; i++){
+					CHECK(parser.dataBytes[i] == ((words[i >> 1] >> ((i & 1) ? 0 : 8)) & 0xFF),
+						"%s: record at %ld: data byte %u", what, recStart, i);
+					out[outLen++] = parser.dataBytes[i];
+				}
+			} else if (status == MCS_PARSE_RECEIVED_EOF) {
+				for (i = 0; (p + i < text + len) && ((p[i] == '\r') || (p[i] == '\n')); i++)
+					;
+				CHECK(p + i == text + len, "%s: EOF record at %ld before the end", what, recStart);
+			} else if (status != MCS_PARSE_RECEIVED_ADDR_EXTEN) {
+				CHECK(0, "%s: record at %ld: status %u", what, recStart, status);
+				return;
+			}
+		}
+		pos = p - text;
+	}
+	CHECK(outLen == binLen, "%s: %ld data bytes, FpgaSample.bin has %ld", what, outLen, binLen);
+	CHECK(memcmp(out, bin, binLen) == 0, "%s: data differs from FpgaSample.bin", what);
+	CHECK(!parser.inRecord, "%s: parser still inside a record at the end", what);
+	printf("parser, %s: %ld records, %ld data bytes match\n", what, records, outLen);
+}
+
+// one bad record: status expected, and no data of it reported
+static void parseBad(const char* what, const char* text, Uint16 expect){
+	struct MCS_STREAM_PARSER parser;
+	Uint16 len = strlen(text), pos = 0, used, status = MCS_PARSE_NO_ERR;
+
+	mcsParseStreamInit(&parser);
+	while (pos < len){
+		status = mcsParseStream(&parser, (char*)text + pos, len - pos, &used);
+		pos += used;
+		if (status > MCS_PARSE_RECEIVED_EOF) break;
+		CHECK(status != MCS_PARSE_RECEIVED_SOME_DATA, "%s: data reported", what);
+	}
+	CHECK(status == expect, "%s: status %u, expected %u", what, status, expect);
+	CHECK(!parser.inRecord, "%s: parser still inside the record", what);
+}
+
+static void parser(void){
+	static char flat[MAX_FIXTURE];
+	long flatLen;
+
+	parseAll("128-char chunks", mcs, mcsLen, 128);
+	parseAll("1 char at a time", mcs, mcsLen, 1);
+	stripLineEnds(mcs, mcsLen, flat, &flatLen);
+	parseAll("no CR/LF", flat, flatLen, 128);
+
+	parseBad("bad checksum", ":10FE1000AA9955665C413359FFE0B0CB87F7B70429\r\n", MCS_PARSE_BAD_CHECK_SUM);
+	parseBad("bad data digit", ":10FE1000AA9955665C413359FFE0B0CB87F7B70528\r\n", MCS_PARSE_BAD_CHECK_SUM);
+	parseBad("non-hex", ":10FE1000AA9955665C41335GFFE0B0CB87F7B70428\r\n", MCS_PARSE_NON_HEX_CHAR);
+	parseBad("cut short", ":10FE1000AA9955665C413359FFE0B0CB87\r\n", MCS_PARSE_BAD_CHAR_COUNT);
+	parseBad("too long", ":11FE1000AA9955665C413359FFE0B0CB87F7B7040027\r\n", MCS_PARSE_BAD_CHAR_COUNT);
+	parseBad("junk between", ":020000040000FA\r\nx:00000001FF\r\n", MCS_PARSE_BOGUS_FIRST_CHAR);
+	parseBad("bad type", ":00000002FE\r\n", MCS_PARSE_BAD_REC_TYPE);
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// 2. download, as the PC does it
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+static struct MULTI_PACKET_BUF mpb;
+
+static void backgroundTasks(void){
+	int n;
+
+	for (n = 0; n < 8; n++){
+		taskMgr_runBkgndTasks();
+	}
+}
+
+// 0x204C.05: room for how many characters, or -1 if the receive has stopped
+static int room(void){
+	Uint16 data[4] = {0, 0, 0, 0};
+
+	frw_mcsFileRecvStatus(NULL, data);
+	if ((data[3] >> 8) == MCS_FILE_STOPPED_FOR_ERROR) return -1;
+	return data[2] & 0x00FF;
+}
+
+static void startDownload(Uint16 algorithm, Uint32 offset){
+	Uint16 data[4] = {0, 0, algorithm, 0};
+
+	spiFlashSim_reset();
+	taskMgr_init();
+	frw_startMcsFileRecv(NULL, data);
+	frwFlashAddr.all = offset;					// 0x204C.01
+}
+
+// the PC polls 0x204C.05 until the last of the file is in flash
+static void waitIdle(void){
+	int waits = 0;
+
+	while ((mcsFileRecvStatus == MCS_FILE_RECV_EOF_BKGND) && (++waits < 1000)){
+		room();
+		backgroundTasks();
+	}
+}
+
+// wait for room for need bytes, then send count characters
+static int send(enum CANOPEN_STATUS (*recv)(const struct CAN_COMMAND*, Uint16*), const char* text, Uint16 count,
+	Uint16 need){
+	int waits = 0;
+
+	while (room() < need){
+		if ((room() < 0) || (++waits > 1000)) return -1;
+		backgroundTasks();
+	}
+	memcpy(mpb.buff, text, count);
+	mpb.count_of_bytes_in_buf = count;
+	return (recv(NULL, (Uint16*)mpb.buff) == CANOPEN_NO_ERR) ? 0 : -1;
+}
+
+// algorithm 2: chunks cut anywhere; returns 0 when the whole file went
+static int streamDownload(const char* text, long len, Uint32 offset){
+	long pos = 0;
+	Uint16 chunk;
+
+	startDownload(2, offset);
+	while (pos < len){
+		chunk = 1 + rand() % 128;
+		if (chunk > len - pos) chunk = len - pos;
+		if (send(frw_mcsStreamRecvData, text + pos, chunk, chunk) != 0) return -1;
+		pos += chunk;
+		if (rand() % 2) backgroundTasks();
+	}
+	waitIdle();
+	return 0;
+}
+
+// algorithm 0: one record per transfer, CR/LF left off, room counted in
+// data bytes
+static int recordDownload(const char* text, long len, Uint32 offset){
+	long pos = 0, end;
+	char count[3] = {0, 0, 0};
+
+	startDownload(0, offset);
+	while (pos < len){
+		end = recordEnd(text, len, pos);
+		memcpy(count, text + pos + 1, 2);
+		if (send(frw_mcsFileRecvData, text + pos, end - pos, strtol(count, NULL, 16)) != 0) return -1;
+		backgroundTasks();
+		pos = end;
+		while ((pos < len) && (text[pos] != ':')) pos++;
+	}
+	waitIdle();
+	return 0;
+}
+
+// FpgaSample.bin at offset, erased everywhere else
+static void checkImage(const char* what, Uint32 offset){
+	long i, erased = 0;
+
+	CHECK(memcmp(spiFlashSim_mem + offset, bin, binLen) == 0, "%s at %05lX: flash differs from FpgaSample.bin",
+		what, (unsigned long)offset);
+	for (i = 0; i < SPI_FLASH_SIM_BYTES; i++){
+		if ((i >= (long)offset) && (i < (long)offset + binLen)) continue;
+		if (spiFlashSim_mem[i] != 0xFF) erased++;
+	}
+	CHECK(erased == 0, "%s at %05lX: %ld bytes written outside the file", what, (unsigned long)offset, erased);
+	CHECK(spiFlashSim_errors == 0, "%s at %05lX: %ld commands the flash refused", what, (unsigned long)offset,
+		spiFlashSim_errors);
+	CHECK(mcsFileRecvStatus == MCS_FILE_RECV_IDLE, "%s at %05lX: receive status %u at the end", what,
+		(unsigned long)offset, mcsFileRecvStatus);
+	CHECK(mcsFileRecvAddrExtension == 0x0001, "%s at %05lX: address extension %04X", what, (unsigned long)offset,
+		mcsFileRecvAddrExtension);
+}
+
+static void downloads(void){
+	static unsigned char image[SPI_FLASH_SIM_BYTES];
+	long streamPages = 0, recordPages = 0, pages;
+	Uint32 offset;
+	int t;
+
+	for (t = 0; t < DOWNLOADS; t++){
+		// page aligned, 128-byte aligned (all algorithm 0 copes with),
+		// anywhere (even), and right up to the end of the chip
+		switch (t % 4){
+		case 0:  offset = (Uint32)(rand() % 0x700) << 8; break;
+		case 1:  offset = ((Uint32)(rand() % 0xE00) << 7) | 0x80; break;
+		case 2:  offset = (Uint32)(rand() % 0x3C000) << 1; break;
+		default: offset = SPI_FLASH_SIM_BYTES - ((binLen + 0xFF) & ~0xFFL); break;
+		}
+		CHECK(streamDownload(mcs, mcsLen, offset) == 0, "algorithm 2 at %05lX: stopped, status %u error %u parse %u",
+			(unsigned long)offset, mcsFileRecvStatus, mcsFileRecvError, mcsFileRecvParseStatus);
+		checkImage("algorithm 2", offset);
+		pages = ((offset & 0xFF) + binLen + 0xFF) >> 8;
+		CHECK(spiFlashSim_pagePrograms == pages, "algorithm 2 at %05lX: %ld page programs for %ld pages",
+			(unsigned long)offset, spiFlashSim_pagePrograms, pages);
+		if ((offset & 0x7F) != 0) continue;
+
+		streamPages += spiFlashSim_pagePrograms;
+		memcpy(image, spiFlashSim_mem, SPI_FLASH_SIM_BYTES);
+		CHECK(recordDownload(mcs, mcsLen, offset) == 0, "algorithm 0 at %05lX: stopped, status %u error %u parse %u",
+			(unsigned long)offset, mcsFileRecvStatus, mcsFileRecvError, mcsFileRecvParseStatus);
+		checkImage("algorithm 0", offset);
+		CHECK(memcmp(image, spiFlashSim_mem, SPI_FLASH_SIM_BYTES) == 0, "at %05lX: algorithms 0 and 2 wrote different images",
+			(unsigned long)offset);
+		recordPages += spiFlashSim_pagePrograms;
+	}
+	CHECK(streamPages < recordPages, "algorithm 2: %ld page programs, algorithm 0 %ld", streamPages, recordPages);
+	printf("download: %d files match FpgaSample.bin, page programs at aligned offsets: algorithm 2 %ld, algorithm 0 %ld\n",
+		DOWNLOADS, streamPages, recordPages);
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// 3. a bad record part way through
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+static void badRecord(void){
+	static char text[MAX_FIXTURE];
+	long rec, pos, badAt, dataBefore = 0, i, written = 0;
+	int t;
+
+	for (t = 0; t < 20; t++){
+		memcpy(text, mcs, mcsLen);
+		// a digit of the checksum of some record past the first page
+		rec = 20 + rand() % 200;
+		for (pos = 0, i = 0; pos < mcsLen; pos++){
+			if ((text[pos] == ':') && (i++ == rec)) break;
+		}
+		badAt = recordEnd(text, mcsLen, pos) - 1;
+		text[badAt] = (text[badAt] == '0') ? '1' : '0';
+		for (dataBefore = 0, i = 0; i < pos; i++){
+			if ((text[i] == ':') && (text[i + 8] == '0')) dataBefore += 16;	// type 00 records are full
+		}
+
+		CHECK(streamDownload(text, mcsLen, 0x1000) != 0, "bad record %ld: download went through", rec);
+		CHECK(mcsFileRecvStatus == MCS_FILE_STOPPED_FOR_ERROR, "bad record %ld: status %u", rec, mcsFileRecvStatus);
+		CHECK(mcsFileRecvError == MCS_ERR_MCS_PARSE_ERR, "bad record %ld: error %u", rec, mcsFileRecvError);
+		CHECK(mcsFileRecvParseStatus == MCS_PARSE_BAD_CHECK_SUM, "bad record %ld: parse status %u", rec, mcsFileRecvParseStatus);
+		// the full pages before it are written, the partial one is not
+		backgroundTasks();
+		written = dataBefore & ~0xFFL;
+		CHECK(memcmp(spiFlashSim_mem + 0x1000, bin, written) == 0, "bad record %ld: the %ld bytes before it not in flash",
+			rec, written);
+		for (i = 0; i < SPI_FLASH_SIM_BYTES; i++){
+			if ((i >= 0x1000) && (i < 0x1000 + written)) continue;
+			if (spiFlashSim_mem[i] != 0xFF) break;
+		}
+		CHECK(i == SPI_FLASH_SIM_BYTES, "bad record %ld: flash written at %05lX", rec, i);
+	}
+	printf("bad record: download stopped with MCS_PARSE_BAD_CHECK_SUM, only the full pages before it in flash\n");
+}
+
+int main(int argc, char** argv){
+	mcsLen = readFile((argc > 2) ? argv[1] : "data/FpgaSample.mcs", mcs, MAX_FIXTURE);
+	binLen = readFile((argc > 2) ? argv[2] : "data/FpgaSample.bin", bin, MAX_FIXTURE);
+	srand(9);
+	parser();
+	downloads();
+	badRecord();
+	printf(fails ? "FAIL (%d)\n" : "PASS\n", fails);
+	return fails != 0;
+}
@@ -0,0 +1,221 @@
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+//
+//     ResolverSine.c
+//
+// Host test and benchmark for the Resolver / SSEnc sine generator in
+// Resolver.C, res_calcSinCosFromHiPrecisShaftAngle(), over all 65536 shaft
+// angles, against sin() / cos() in double precision.
+//  - error: worst and RMS amplitude error in DAC LSBs, worst angle error
+//    (atan2 of the two outputs) in degrees, for the firmware generator and
+//    for the classic test station code it replaced (copied below).  The
+//    default generator must stay within 0.56 LSB.
+//  - cost: TSC ticks per call, firmware generator against the classic
+//    code, both built here with the same compiler.  x86 ticks, only the
+//    ratio means anything for the C28x.
+// Built as ResolverSineClassic with RES_SINE_CLASSIC_TABLE defined, the
+// firmware must give the classic code's output bit for bit.
+//
+//     ResolverSine
+//     ResolverSineClassic
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <x86intrin.h>
+
+#include "DSP281x_Device.h"
+#include "Resolver.H"
+
+#define ANGLES 65536L
+#define COST_PASSES 200
+#define DEFAULT_WORST_LSB 0.56
+
+static int fails;
+#define CHECK(c, ...) do { if (!(c)) { printf("FAIL %s:%d ", __FILE__, __LINE__); \
+	printf(__VA_ARGS__); printf("\n"); fails++; if (fails > 10) exit(1); } } while (0)
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// the classic test station generator Resolver.C had before
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+static void classicCalc(Uint16 data, Uint16* sin_ret, Uint16* cos_ret){
+	Uint16 cos;
+	Uint16 sin;
+	Uint16 n;
+	Uint16 remainder;
+
+	static const Uint16 sine_tbl[] = {
+	0,13,25,38,50,63,75,88,100,113,
+	126,138,151,163,176,188,201,213,226,238,
+	251,263,275,288,300,313,325,338,350,362,
+	375,387,399,412,424,436,449,461,473,485,
+	497,510,522,534,546,558,570,582,594,606,
+	618,630,642,654,666,678,690,701,713,725,
+	737,748,760,772,783,795,807,818,830,841,
+	852,864,875,887,898,909,920,932,943,954,
+	965,976,987,998,1009,1020,1031,1042,1052,1063,
+	1074,1085,1095,1106,1116,1127,1137,1148,1158,1168,
+	1179,1189,1199,1209,1219,1229,1239,1249,1259,1269,
+	1279,1289,1299,1308,1318,1328,1337,1347,1356,1365,
+	1375,1384,1393,1402,1411,1421,1430,1439,1447,1456,
+	1465,1474,1483,1491,1500,1508,1517,1525,1533,1542,
+	1550,1558,1566,1574,1582,1590,1598,1606,1614,1621,
+	1629,1637,1644,1652,1659,1666,1674,1681,1688,1695,
+	1702,1709,1716,1723,1729,1736,1743,1749,1756,1762,
+	1769,1775,1781,1787,1793,1799,1805,1811,1817,1823,
+	1828,1834,1840,1845,1850,1856,1861,1866,1871,1876,
+	1881,1886,1891,1896,1901,1905,1910,1914,1919,1923,
+	1927,1932,1936,1940,1944,1948,1951,1955,1959,1962,
+	1966,1969,1973,1976,1979,1983,1986,1989,1992,1994,
+	1997,2000,2003,2005,2008,2010,2012,2015,2017,2019,
+	2021,2023,2025,2027,2028,2030,2032,2033,2035,2036,
+	2037,2038,2039,2040,2041,2042,2043,2044,2045,2045,
+	2046,2046,2046,2047,2047,2047,2047,
+	2047};
+
+	if (data < 0x4000)
+	{
+		n = data>>6;
+		remainder = data & 0x003f;
+		sin = sine_tbl[n] + 0x800 + (((sine_tbl[n+1] - sine_tbl[n]) * remainder)>>6);
+		n = (0x4000 - data)>>6;
+		remainder = (0x4000 - data) & 0x003f;
+		cos = sine_tbl[n] + 0x800 + (((sine_tbl[n+1] - sine_tbl[n]) * remainder)>>6);
+	}
+	else if (data < 0x8000)
+	{
+		n = (0x8000 - data)>>6;
+		remainder = (0x8000 - data) & 0x003f;
+		sin = sine_tbl[n] + 0x800 + (((sine_tbl[n+1] - sine_tbl[n]) * remainder)>>6);
+		n = (data - 0x4000)>>6;
+		remainder = (data - 0x4000) & 0x003f;
+		cos = 0x800 - (sine_tbl[n] + (((sine_tbl[n+1] - sine_tbl[n]) * remainder)>>6));
+	}
+	else if (data < 0xC000)
+	{
+		n = (data - 0x8000)>>6;
+		remainder = (data - 0x8000) & 0x003f;
+		sin = 0x800 -  (sine_tbl[n] + (((sine_tbl[n+1] - sine_tbl[n]) * remainder)>>6));
+		n = (0xC000 - data)>>6;
+		remainder = (0xC000 - data) & 0x003f;
+		cos = 0x800 - (sine_tbl[n] + (((sine_tbl[n+1] - sine_tbl[n]) * remainder)>>6));
+	}
+	else
+	{
+		n = ((0xFFFF ^ data) + 1)>>6;
+		remainder = ((0xFFFF ^ data) + 1) & 0x003f;
+		sin = 0x800 -  (sine_tbl[n] + (((sine_tbl[n+1] - sine_tbl[n]) * remainder)>>6));
+		n = (data - 0xC000)>>6;
+		remainder = (data - 0xC000) & 0x003f;
+		cos = sine_tbl[n] + 0x800 + (((sine_tbl[n+1] - sine_tbl[n]) * remainder)>>6);
+	}
+
+	cos = 0xFFF - cos;
+	sin = 0xFFF - sin;
+
+	*sin_ret = sin;
+	*cos_ret = cos;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// error against double precision
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+typedef void (*GENERATOR)(Uint16 data, Uint16* sin_ret, Uint16* cos_ret);
+
+struct SINE_ERROR {
+	double worstLsb;
+	long worstAt;
+	double rmsLsb;
+	double worstDeg;
+};
+
+// DAC value back to the signed amplitude, the DAC output is sign-reversed
+static double amplitude(Uint16 dac){
+	return (double)(0xFFF - dac) - 0x800;
+}
+
+static double angleDiff(double a, double b){
+	double d = fmod(a - b, 360.0);
+
+	if (d > 180.0) d -= 360.0;
+	if (d < -180.0) d += 360.0;
+	return fabs(d);
+}
+
+static struct SINE_ERROR sineError(const char* name, GENERATOR gen){
+	struct SINE_ERROR e = {0, 0, 0, 0};
+	double sum = 0, theta, es, ec, deg;
+	Uint16 s, c;
+	long a;
+
+	for (a = 0; a < ANGLES; a++){
+		gen((Uint16)a, &s, &c);
+		CHECK((s <= 0xFFF) && (c <= 0xFFF), "%s: angle %04lX out of DAC range: sin %04X cos %04X", name, a, s, c);
+		theta = a * 2 * M_PI / ANGLES;
+		es = fabs(amplitude(s) - 2047 * sin(theta));
+		ec = fabs(amplitude(c) - 2047 * cos(theta));
+		sum += es * es + ec * ec;
+		if (es > e.worstLsb) { e.worstLsb = es; e.worstAt = a; }
+		if (ec > e.worstLsb) { e.worstLsb = ec; e.worstAt = a; }
+		deg = angleDiff(atan2(amplitude(s), amplitude(c)) * 180 / M_PI, a * 360.0 / ANGLES);
+		if (deg > e.worstDeg) e.worstDeg = deg;
+	}
+	e.rmsLsb = sqrt(sum / (2 * ANGLES));
+	printf("%-9s worst %.3f LSB (angle %04lX), rms %.3f LSB, worst angle error %.4f deg\n",
+		name, e.worstLsb, e.worstAt, e.rmsLsb, e.worstDeg);
+	return e;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// cost: best of COST_PASSES passes over every angle
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+static volatile Uint16 sink;
+
+static double ticksPerCall(GENERATOR gen){
+	unsigned long long t0, t, best = ~0ULL;
+	Uint16 s, c, acc;
+	long a;
+	int pass;
+
+	for (pass = 0; pass < COST_PASSES; pass++){
+		acc = 0;
+		t0 = __rdtsc();
+		for (a = 0; a < ANGLES; a++){
+			gen((Uint16)a, &s, &c);
+			acc += s ^ c;
+		}
+		t = __rdtsc() - t0;
+		sink = acc;
+		if (t < best) best = t;
+	}
+	return (double)best / ANGLES;
+}
+
+int main(void){
+	struct SINE_ERROR fw, classic;
+	Uint16 s1, c1, s2, c2;
+	double tFw, tClassic;
+	long a, differ = 0;
+
+	fw = sineError("firmware", res_calcSinCosFromHiPrecisShaftAngle);
+	classic = sineError("classic", classicCalc);
+	tFw = ticksPerCall(res_calcSinCosFromHiPrecisShaftAngle);
+	tClassic = ticksPerCall(classicCalc);
+	printf("cost: firmware %.1f, classic %.1f TSC ticks per sin/cos pair\n", tFw, tClassic);
+
+	for (a = 0; a < ANGLES; a++){
+		res_calcSinCosFromHiPrecisShaftAngle((Uint16)a, &s1, &c1);
+		classicCalc((Uint16)a, &s2, &c2);
+		if ((s1 != s2) || (c1 != c2)) differ++;
+	}
+#ifdef RES_SINE_CLASSIC_TABLE
+	CHECK(differ == 0, "RES_SINE_CLASSIC_TABLE: %ld angles differ from the classic code", differ);
+#else
+	CHECK(fw.worstLsb < DEFAULT_WORST_LSB, "worst error %.3f LSB, over %.2f", fw.worstLsb, DEFAULT_WORST_LSB);
+	CHECK(fw.worstLsb < classic.worstLsb, "no better than the classic code");
+	CHECK(fw.worstDeg < classic.worstDeg, "angle error no better than the classic code");
+	printf("%ld of %ld angles differ from the classic code\n", differ, ANGLES);
+#endif
+	printf(fails ? "FAIL (%d)\n" : "PASS\n", fails);
+	return fails != 0;
+}
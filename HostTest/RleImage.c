@@ -0,0 +1,76 @@
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+//
+//     RleImage.c
+//
+// See RleImage.h.  main() is built in with -DRLE_IMAGE_MAIN only.
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "RleImage.h"
+
+#define RLE_MAX_LITERAL 128
+#define RLE_MAX_RUN     128
+#define RLE_MIN_RUN     3		// a run of 2 costs what 2 literal bytes do
+#define RLE_END         0x80
+
+long rleImage_encode(const unsigned char* image, long len, unsigned char* out){
+	long i = 0, o = 0;
+	long literal = -1;			// out[literal] is the control byte of the open literal block
+	long run;
+
+	while (i < len){
+		for (run = 1; (i + run < len) && (image[i + run] == image[i]) && (run < RLE_MAX_RUN); run++)
+			;
+		if (run >= RLE_MIN_RUN) {
+			out[o++] = 0x7F + run;
+			out[o++] = image[i];
+			i += run;
+			literal = -1;
+		} else {
+			if ((literal < 0) || (out[literal] == RLE_MAX_LITERAL - 1)) {
+				literal = o;
+				out[o++] = 0;
+			} else {
+				out[literal]++;
+			}
+			out[o++] = image[i++];
+		}
+	}
+	out[o++] = RLE_END;
+	return o;
+}
+
+#ifdef RLE_IMAGE_MAIN
+#define MAX_IMAGE 0x80000L		// the M25P40
+
+int main(int argc, char** argv){
+	static unsigned char image[MAX_IMAGE + 1];
+	static unsigned char out[RLE_IMAGE_MAX(MAX_IMAGE)];
+	FILE* f;
+	long len, outLen;
+
+	if (argc != 3) {
+		fprintf(stderr, "usage: RleImage image.bin image.rle\n");
+		return 2;
+	}
+	if ((f = fopen(argv[1], "rb")) == NULL) {
+		perror(argv[1]);
+		return 1;
+	}
+	len = (long)fread(image, 1, sizeof image, f);
+	fclose(f);
+	if (len > MAX_IMAGE) {
+		fprintf(stderr, "%s: more than the %ld bytes the FLASH holds\n", argv[1], MAX_IMAGE);
+		return 1;
+	}
+	outLen = rleImage_encode(image, len, out);
+	if (((f = fopen(argv[2], "wb")) == NULL) || (fwrite(out, 1, outLen, f) != (size_t)outLen) || (fclose(f) != 0)) {
+		perror(argv[2]);
+		return 1;
+	}
+	printf("%s: %ld bytes, %ld encoded (%.0f%%)\n", argv[1], len, outLen, len ? 100.0 * outLen / len : 100.0);
+	return 0;
+}
+#endif
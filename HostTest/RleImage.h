@@ -0,0 +1,28 @@
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+//
+//     RleImage.h
+//
+// The PC side of download algorithm 3 (frw_startMcsFileRecv() with 3, data
+// through 0x204C.23): a binary image run-length encoded the way
+// frw_rleStreamDecode() in FlashRW.C decodes it.
+//   control byte 0x00-0x7F: the next (control + 1) bytes are literal data
+//   control byte 0x81-0xFF: the next byte is repeated (control - 0x7F) times
+//   control byte 0x80:      end of image
+// Runs of 3 or more of a byte are encoded as runs, everything else goes in
+// literal blocks of up to 128 bytes.  Built on its own (make tools) it is
+// the tool that encodes an image file:
+//     RleImage image.bin image.rle
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+#ifndef RLEIMAGE_H
+#define RLEIMAGE_H
+
+// most bytes len bytes of image can encode to: a control byte for every
+// 128 literal bytes, and the end of image
+#define RLE_IMAGE_MAX(len) ((len) + ((len) + 127) / 128 + 1)
+
+// encode len bytes of image into out, end of image included; returns the
+// length of the encoding
+long rleImage_encode(const unsigned char* image, long len, unsigned char* out);
+
+#endif
@@ -0,0 +1,297 @@
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+//
+//     RleStream.c
+//
+// Host test for download algorithm 3 in FlashRW.C (0x204C.04 = 3, data
+// through 0x204C.23), frw_rleStreamRecvData() and frw_rleStreamDecode(),
+// with images encoded by rleImage_encode() (RleImage.c, the PC tool).
+//  1. round trip: data/FpgaSample.bin, bitstream-like images (long runs of
+//     00 and FF between random data), random data, and the edges of the
+//     format -- no data, 1 byte, runs of 2, 3, 128, 129 and 257, literal
+//     blocks of 127, 128 and 129 bytes, odd lengths.  The PC side polls
+//     0x204C.05 for room and sends 1 - 128 bytes at a time, the background
+//     tasks running at random in between.  The flash (SpiFlashSim.c) must
+//     hold the image byte for byte at the offset given, page aligned or
+//     not, and be erased everywhere else (an odd last byte is padded with
+//     FF), with one page program per page the image touches
+//  2. the encoding: no bigger than RLE_IMAGE_MAX(), random data grows by
+//     under 1%, and bitstream-like images shrink
+//  3. the PC sending without room, or to 0x204C.23 in another download
+//     algorithm: the download stops with an error; anything after the end
+//     of image is ignored
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "DSP281x_Device.h"
+#include "stdbool.h"
+#include "CanOpen.H"
+#include "FlashRW.H"
+#include "TaskMgr.h"
+#include "SpiFlashSim.h"
+#include "RleImage.h"
+
+// FlashRW.C internals
+extern Uint16 mcsFileRecvStatus;
+extern Uint16 mcsFileRecvError;
+
+#define MAX_IMAGE 0x10000L
+#define CHUNK 128				// bytes in a multi-packet buffer
+
+static int fails;
+#define CHECK(c, ...) do { if (!(c)) { printf("FAIL %s:%d ", __FILE__, __LINE__); \
+	printf(__VA_ARGS__); printf("\n"); fails++; if (fails > 10) exit(1); } } while (0)
+
+static unsigned char image[MAX_IMAGE];
+static unsigned char encoded[RLE_IMAGE_MAX(MAX_IMAGE)];
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// the download, as the PC does it
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+static struct MULTI_PACKET_BUF mpb;
+
+static void backgroundTasks(void){
+	int n;
+
+	for (n = 0; n < 8; n++){
+		taskMgr_runBkgndTasks();
+	}
+}
+
+// 0x204C.05: room for how many bytes, or -1 if the receive has stopped;
+// none while it reports the flash busy, the data would be refused
+static int room(void){
+	Uint16 data[4] = {0, 0, 0, 0};
+
+	frw_mcsFileRecvStatus(NULL, data);
+	if ((data[3] >> 8) == MCS_FILE_STOPPED_FOR_ERROR) return -1;
+	if ((data[3] & 0x00FF) == MCS_ERR_WRITE_IN_PROG) return 0;
+	return data[2] & 0x00FF;
+}
+
+static void startDownload(Uint16 algorithm, Uint32 offset){
+	Uint16 data[4] = {0, 0, algorithm, 0};
+
+	spiFlashSim_reset();
+	taskMgr_init();
+	frw_startMcsFileRecv(NULL, data);
+	frwFlashAddr.all = offset;					// 0x204C.01
+}
+
+static enum CANOPEN_STATUS sendNow(const unsigned char* bytes, Uint16 count){
+	memcpy(mpb.buff, bytes, count);
+	mpb.count_of_bytes_in_buf = count;
+	return frw_rleStreamRecvData(NULL, (Uint16*)mpb.buff);
+}
+
+// the whole encoding, in chunks cut anywhere; 0 when it all went
+static int download(const unsigned char* enc, long len, Uint32 offset){
+	long pos = 0;
+	Uint16 chunk;
+	int waits;
+
+	startDownload(3, offset);
+	while (pos < len){
+		chunk = 1 + rand() % CHUNK;
+		if (chunk > len - pos) chunk = len - pos;
+		for (waits = 0; room() < chunk; waits++){
+			if ((room() < 0) || (waits > 1000)) return -1;
+			backgroundTasks();
+		}
+		if (sendNow(enc + pos, chunk) != CANOPEN_NO_ERR) return -1;
+		pos += chunk;
+		if (rand() % 2) backgroundTasks();
+	}
+	// the PC polls 0x204C.05 until the last of it is in flash; the end of
+	// image may still be waiting to be decoded
+	for (waits = 0; (mcsFileRecvStatus != MCS_FILE_RECV_IDLE) && (waits < 1000); waits++){
+		if (room() < 0) return -1;
+		backgroundTasks();
+	}
+	return 0;
+}
+
+// the image at offset, erased everywhere else
+static void checkFlash(const char* what, long len, Uint32 offset){
+	long i, written = 0;
+	long pages = len ? ((offset & 0xFF) + len + 0xFF) >> 8 : 0;
+
+	CHECK(memcmp(spiFlashSim_mem + offset, image, len) == 0, "%s at %05lX: flash differs from the image",
+		what, (unsigned long)offset);
+	for (i = 0; i < SPI_FLASH_SIM_BYTES; i++){
+		if ((i >= (long)offset) && (i < (long)offset + len)) continue;
+		if (spiFlashSim_mem[i] != 0xFF) written++;
+	}
+	CHECK(written == 0, "%s at %05lX: %ld bytes written outside the image", what, (unsigned long)offset, written);
+	CHECK(spiFlashSim_pagePrograms == pages, "%s at %05lX: %ld page programs for %ld pages", what,
+		(unsigned long)offset, spiFlashSim_pagePrograms, pages);
+	CHECK(spiFlashSim_errors == 0, "%s at %05lX: %ld commands the flash refused", what, (unsigned long)offset,
+		spiFlashSim_errors);
+	CHECK(mcsFileRecvStatus == MCS_FILE_RECV_IDLE, "%s at %05lX: receive status %u at the end", what,
+		(unsigned long)offset, mcsFileRecvStatus);
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// the images
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+static long sample(void){
+	FILE* f = fopen("data/FpgaSample.bin", "rb");
+	long n;
+
+	if (f == NULL) {
+		printf("FAIL can't open data/FpgaSample.bin\n");
+		exit(1);
+	}
+	n = (long)fread(image, 1, MAX_IMAGE, f);
+	fclose(f);
+	return n;
+}
+
+// runs of 00 and FF (unused frames) between stretches of random data
+static long bitstreamLike(long len){
+	long i = 0, n;
+	unsigned char b;
+
+	while (i < len){
+		n = 1 + rand() % ((rand() % 3) ? 300 : 2000);
+		if (n > len - i) n = len - i;
+		if (rand() % 2) {
+			b = (rand() % 2) ? 0x00 : 0xFF;
+			memset(image + i, b, n);
+		} else {
+			while (n-- > 0) image[i++] = rand();
+			continue;
+		}
+		i += n;
+	}
+	return len;
+}
+
+static long randomData(long len){
+	long i;
+
+	for (i = 0; i < len; i++){
+		image[i] = rand();
+	}
+	return len;
+}
+
+// the edges of the format: runs around 3 and 128, literal blocks around
+// 128, odd lengths
+static long edges(int k){
+	static const struct { int run; int literal; } e[] = {
+		{0, 0}, {0, 1}, {1, 0}, {2, 0}, {3, 0}, {2, 2}, {128, 0}, {129, 0}, {130, 0}, {257, 0},
+		{0, 127}, {0, 128}, {0, 129}, {0, 257}, {127, 129}, {129, 127}, {3, 1}, {1, 3}
+	};
+	long i, len = 0;
+	int r;
+
+	for (r = 0; r < 5; r++){
+		for (i = 0; i < e[k].run; i++){
+			image[len++] = 0x40 + r;
+		}
+		for (i = 0; i < e[k].literal; i++){
+			image[len++] = (i & 1) ? 0x55 : i;	// no 3 bytes alike
+		}
+		if ((e[k].run == 0) && (e[k].literal <= 1)) break;
+	}
+	return len;
+}
+#define EDGES 18
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// 1., 2.
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+static Uint32 offsetFor(int t, long len){
+	switch (t % 4){
+	case 0:  return (Uint32)(rand() % 0x700) << 8;				// page aligned
+	case 1:  return ((Uint32)(rand() % 0x38000) << 1) | 0xFE;	// the last word of a page
+	case 2:  return (Uint32)(rand() % 0x38000) << 1;			// anywhere (even)
+	default: return (SPI_FLASH_SIM_BYTES - len) & ~1L;			// right up to the end of the chip
+	}
+}
+
+static long roundTrip(const char* what, long len, int t){
+	Uint32 offset = offsetFor(t, len);
+	long encLen = rleImage_encode(image, len, encoded);
+
+	CHECK(encLen <= RLE_IMAGE_MAX(len), "%s: %ld bytes encoded to %ld", what, len, encLen);
+	CHECK(download(encoded, encLen, offset) == 0, "%s at %05lX: stopped, status %u error %u", what,
+		(unsigned long)offset, mcsFileRecvStatus, mcsFileRecvError);
+	checkFlash(what, len, offset);
+	return encLen;
+}
+
+static void roundTrips(void){
+	long len, enc, bitstreamBytes = 0, bitstreamEnc = 0;
+	char what[60];
+	int t;
+
+	len = sample();
+	enc = roundTrip("FpgaSample.bin", len, 0);
+	printf("FpgaSample.bin: %ld bytes, %ld encoded\n", len, enc);
+	for (t = 0; t < EDGES; t++){
+		len = edges(t);
+		sprintf(what, "edge case %d, %ld bytes", t, len);
+		roundTrip(what, len, t);
+	}
+	for (t = 0; t < 24; t++){
+		len = bitstreamLike(1 + rand() % MAX_IMAGE);
+		sprintf(what, "bitstream-like image %d, %ld bytes", t, len);
+		bitstreamBytes += len;
+		bitstreamEnc += roundTrip(what, len, t);
+	}
+	CHECK(bitstreamEnc < bitstreamBytes * 3 / 4, "bitstream-like images: %ld bytes encoded to %ld", bitstreamBytes, bitstreamEnc);
+	for (t = 0; t < 8; t++){
+		len = randomData(1 + rand() % MAX_IMAGE);
+		sprintf(what, "random data %d, %ld bytes", t, len);
+		enc = roundTrip(what, len, t);
+		CHECK(enc < len + len / 100, "%s: encoded to %ld", what, enc);
+	}
+	printf("round trip: FpgaSample.bin, %d edge cases, bitstream-like images encoded to %.0f%%, random data\n",
+		EDGES, 100.0 * bitstreamEnc / bitstreamBytes);
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// 3.
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+static void misuse(void){
+	static unsigned char junk[CHUNK];
+	long len, encLen;
+
+	// a run that fills more than the stream buffer, then a chunk without
+	// waiting for room
+	memset(image, 0xA5, 4000);
+	encLen = rleImage_encode(image, 4000, encoded);
+	startDownload(3, 0x1000);
+	CHECK(sendNow(encoded, 2 * 16) == CANOPEN_NO_ERR, "no room: first chunk refused");
+	CHECK(room() == 0, "no room: room for %d with the chunk not decoded", room());
+	CHECK(sendNow(encoded + 32, encLen - 32) != CANOPEN_NO_ERR, "no room: second chunk taken");
+	CHECK((mcsFileRecvStatus == MCS_FILE_STOPPED_FOR_ERROR) && (mcsFileRecvError == MCS_ERR_RECV_BUFF_OVERRUN),
+		"no room: status %u error %u", mcsFileRecvStatus, mcsFileRecvError);
+
+	// 0x204C.23 in an MCS stream download
+	startDownload(2, 0x1000);
+	CHECK(sendNow(encoded, encLen) != CANOPEN_NO_ERR, "algorithm 2: 0x204C.23 taken");
+
+	// bytes after the end of image, in its chunk and after it
+	len = bitstreamLike(3000);
+	encLen = rleImage_encode(image, len, encoded);
+	memset(junk, 0x00, sizeof junk);
+	memcpy(encoded + encLen, junk, 20);
+	CHECK(download(encoded, encLen + 20, 0x2000) == 0, "after the end: download stopped");
+	CHECK(sendNow(junk, sizeof junk) == CANOPEN_NO_ERR, "after the end: chunk refused");
+	backgroundTasks();
+	checkFlash("bytes after the end", len, 0x2000);
+	printf("misuse: chunk without room stops the download, 0x204C.23 only in algorithm 3, bytes after the end ignored\n");
+}
+
+int main(void){
+	srand(15);
+	roundTrips();
+	misuse();
+	printf(fails ? "FAIL (%d)\n" : "PASS\n", fails);
+	return fails != 0;
+}
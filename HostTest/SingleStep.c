@@ -0,0 +1,77 @@
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+//
+//     SingleStep.c
+//
+// See SingleStep.h.  x86-64 Linux only.
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+#define _GNU_SOURCE
+#include <signal.h>
+#include <string.h>
+#include <ucontext.h>
+
+#include "DSP281x_Device.h"
+#include "SingleStep.h"
+
+#define TRAP_FLAG 0x100
+
+volatile Uint16 hostIntsDisabled;
+
+static volatile int tracing;
+static volatile long steps;
+static long injectAt;
+static void (*isrFn)(void);
+static volatile int isrDone;
+
+Uint16 __disable_interrupts(void){
+	Uint16 intState = hostIntsDisabled;
+
+	hostIntsDisabled = 1;
+	return intState;
+}
+
+void __restore_interrupts(Uint16 intState){
+	hostIntsDisabled = intState;
+}
+
+// SIGTRAP after every instruction while the trap flag is set.  The kernel
+// clears the flag while a handler runs, so the ISR itself is not traced.
+static void trapHandler(int sig, siginfo_t* info, void* context){
+	ucontext_t* uc = context;
+
+	(void)sig; (void)info;
+	if (!tracing) {
+		uc->uc_mcontext.gregs[REG_EFL] &= ~TRAP_FLAG;
+		return;
+	}
+	if ((++steps == injectAt) && !hostIntsDisabled) {
+		hostIntsDisabled = 1;	// as the C28x does on taking an interrupt
+		isrFn();
+		hostIntsDisabled = 0;
+		isrDone = 1;
+	}
+}
+
+long singleStep_run(void (*fn)(void), long at, void (*isr)(void), int* isrRan){
+	static int installed;
+	struct sigaction sa;
+
+	if (!installed) {
+		memset(&sa, 0, sizeof sa);
+		sa.sa_sigaction = trapHandler;
+		sa.sa_flags = SA_SIGINFO;
+		sigaction(SIGTRAP, &sa, NULL);
+		installed = 1;
+	}
+	steps = 0;
+	injectAt = at;
+	isrFn = isr;
+	isrDone = 0;
+	tracing = 1;
+	// set the trap flag, stepping over the red zone before pushing
+	__asm__ volatile ("lea -128(%%rsp), %%rsp\n\tpushf\n\torq $0x100, (%%rsp)\n\tpopf\n\tlea 128(%%rsp), %%rsp" ::: "memory", "cc");
+	fn();
+	tracing = 0;
+	if (isrRan) *isrRan = isrDone;
+	return steps;
+}
@@ -0,0 +1,23 @@
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+//
+//     SingleStep.h
+//
+// Interrupts landing between any two instructions of background code.
+// singleStep_run() runs a function one x86 instruction at a time (trap
+// flag) and calls an "ISR" after a chosen instruction, as an interrupt
+// would on the C28x -- unless the code has interrupts disabled there.
+// SingleStep.c brings __disable_interrupts() / __restore_interrupts(),
+// which just keep hostIntsDisabled, the stand-in for INTM.
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+#ifndef SINGLESTEP_H
+#define SINGLESTEP_H
+
+extern volatile Uint16 hostIntsDisabled;
+
+// Run fn(), calling isr() after instruction number injectAt (1 = the first)
+// if interrupts are enabled there.  Returns the number of instructions fn()
+// took, *isrRan is set if isr() ran.
+long singleStep_run(void (*fn)(void), long injectAt, void (*isr)(void), int* isrRan);
+
+#endif
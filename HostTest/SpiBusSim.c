@@ -0,0 +1,315 @@
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+//
+//     SpiBusSim.c
+//
+// See SpiBusSim.h.
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "DSP281x_Device.h"
+#include "SpiBusSim.h"
+
+#undef SpiaRegs
+#undef SPITXBUF
+#undef SPIRXBUF
+
+#define LSPCLK_CYCLES 2			// CPU cycles per LSPCLK cycle
+#define IDLE_POLLS 1000000L		// accesses with the SPI idle before a wait is given up on
+
+// SPIFFTX
+#define SPIFFENA   0x4000
+#define TXFIFO     0x2000
+#define FFTX_WR    0xE03F		// the bits a write sets
+// SPIFFRX
+#define RXFFOVF    0x8000
+#define RXFFOVFCLR 0x4000
+#define RXFIFORESET 0x2000
+#define FFRX_WR    0x203F
+// SPISTS
+#define OVERRUN_FLAG 0x0080
+#define INT_FLAG     0x0040
+#define BUFFULL_FLAG 0x0020
+
+unsigned char spiBusSim_mem[SPI_BUS_SIM_BYTES];
+double spiBusSim_cycles;
+double spiBusSim_cyclesPerAccess = 4;
+long spiBusSim_isrEvery;
+double spiBusSim_isrCycles;
+Uint16 spiBusSim_status;
+long spiBusSim_overruns;
+long spiBusSim_txLost;
+long spiBusSim_emptyReads;
+long spiBusSim_clockErrors;
+int spiBusSim_maxRxFifo;
+long spiBusSim_words;
+long spiBusSim_dataBytes;
+double spiBusSim_busyCycles;
+
+static volatile struct SPI_REGS regs;
+static double lastAccess;		// when the access sync() applies the writes of was made
+static long accesses;
+static long idlePolls;			// accesses since the SPI last had anything to do
+static Uint16 fftx, ffrx;		// what the firmware last set
+static Uint16 shownFftx, shownFfrx;	// and what it was shown, to see its writes by
+static int overrun;
+static int intFlag;
+static Uint16 rxBuf;
+
+struct WORD {
+	Uint16 data;
+	double at;				// written to SPITXBUF
+};
+static struct WORD txSlot;		// a SPITXBUF write, until sync() applies it
+static int txPending;
+static struct WORD txBuf;		// no FIFO
+static int txBufFull;
+static struct WORD txFifo[SPI_BUS_SIM_FIFO];
+static int txHead, txCount;
+static Uint16 rxFifo[SPI_BUS_SIM_FIFO];
+static int rxHead, rxCount;
+
+static int shifting;
+static Uint16 shiftOut;
+static int shiftBits;
+static double shiftEnd;
+
+// the FLASH
+enum FLASH_STATE { FL_COMMAND, FL_ADDRESS, FL_DUMMY, FL_DATA, FL_STATUS, FL_IGNORE };
+static enum FLASH_STATE flState;
+static Uint16 flCommand;
+static int flAddrBytes;
+static Uint32 flAddr;
+
+void spiBusSim_reset(void){
+	memset(spiBusSim_mem, 0xFF, sizeof spiBusSim_mem);
+	memset((void*)&regs, 0, sizeof regs);
+	regs.SPICCR.all = 0x000F;
+	spiBusSim_cycles = 0;
+	spiBusSim_isrEvery = 0;
+	spiBusSim_status = 0;
+	spiBusSim_overruns = 0;
+	spiBusSim_txLost = 0;
+	spiBusSim_emptyReads = 0;
+	spiBusSim_clockErrors = 0;
+	spiBusSim_maxRxFifo = 0;
+	spiBusSim_words = 0;
+	spiBusSim_dataBytes = 0;
+	spiBusSim_busyCycles = 0;
+	lastAccess = 0;
+	accesses = 0;
+	idlePolls = 0;
+	fftx = shownFftx = 0;
+	ffrx = shownFfrx = 0;
+	overrun = intFlag = 0;
+	rxBuf = 0;
+	txPending = txBufFull = 0;
+	txHead = txCount = rxHead = rxCount = 0;
+	shifting = 0;
+	shiftEnd = 0;
+	flState = FL_IGNORE;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// the FLASH, a byte at a time
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void spiBusSim_select(void){
+	spiBusSim_idle();
+	flState = FL_COMMAND;
+}
+
+static Uint16 flashByte(Uint16 in, double bitsPerSec){
+	Uint16 out = 0xFF;
+
+	switch (flState){
+	case FL_COMMAND:
+		flCommand = in;
+		flAddrBytes = 0;
+		flAddr = 0;
+		if ((in == 0x03) || (in == 0x0B)) {
+			if (bitsPerSec > ((in == 0x03) ? 20e6 : 25e6)) spiBusSim_clockErrors++;
+			flState = FL_ADDRESS;
+		} else if (in == 0x05) {
+			flState = FL_STATUS;
+		} else {
+			flState = FL_IGNORE;
+		}
+		break;
+	case FL_ADDRESS:
+		flAddr = (flAddr << 8) | in;
+		if (++flAddrBytes == 3) {
+			flState = (flCommand == 0x0B) ? FL_DUMMY : FL_DATA;
+		}
+		break;
+	case FL_DUMMY:
+		flState = FL_DATA;
+		break;
+	case FL_DATA:
+		out = spiBusSim_mem[flAddr % SPI_BUS_SIM_BYTES];
+		flAddr++;
+		spiBusSim_dataBytes++;
+		break;
+	case FL_STATUS:
+		out = spiBusSim_status & 0x00FF;
+		break;
+	default:
+		break;
+	}
+	return out;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// the SPI
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+static void startShift(struct WORD w){
+	double start = (w.at > shiftEnd) ? w.at : shiftEnd;
+	Uint16 brr = (regs.SPIBRR < 3) ? 3 : regs.SPIBRR;
+
+	shifting = 1;
+	shiftOut = w.data;
+	shiftBits = regs.SPICCR.bit.SPICHAR + 1;
+	shiftEnd = start + shiftBits * (brr + 1) * LSPCLK_CYCLES;
+	spiBusSim_busyCycles += shiftEnd - start;
+}
+
+static void endShift(void){
+	Uint16 brr = (regs.SPIBRR < 3) ? 3 : regs.SPIBRR;
+	double bitsPerSec = 150e6 / LSPCLK_CYCLES / (brr + 1);
+	Uint16 in;
+
+	shifting = 0;
+	spiBusSim_words++;
+	if (shiftBits == 16) {
+		in = flashByte(shiftOut >> 8, bitsPerSec) << 8;
+		in |= flashByte(shiftOut & 0x00FF, bitsPerSec);
+	} else if (shiftBits == 8) {
+		in = flashByte(shiftOut >> 8, bitsPerSec);
+	} else {
+		in = 0xFFFF;
+	}
+	if (fftx & SPIFFENA) {
+		if (!(ffrx & RXFIFORESET)) return;
+		if (rxCount == SPI_BUS_SIM_FIFO) {
+			spiBusSim_overruns++;
+			ffrx |= RXFFOVF;
+			return;
+		}
+		rxFifo[(rxHead + rxCount) % SPI_BUS_SIM_FIFO] = in;
+		rxCount++;
+		if (rxCount > spiBusSim_maxRxFifo) spiBusSim_maxRxFifo = rxCount;
+	} else {
+		if (intFlag) {
+			spiBusSim_overruns++;
+			overrun = 1;
+		}
+		rxBuf = in;
+		intFlag = 1;
+	}
+}
+
+// shift what there is to shift, up to cycle t
+static void advance(double t){
+	for (;;){
+		if (shifting) {
+			if (shiftEnd > t) return;
+			endShift();
+		} else if ((fftx & SPIFFENA) && (txCount > 0)) {
+			startShift(txFifo[txHead]);
+			txHead = (txHead + 1) % SPI_BUS_SIM_FIFO;
+			txCount--;
+		} else if (!(fftx & SPIFFENA) && txBufFull) {
+			startShift(txBuf);
+			txBufFull = 0;
+		} else {
+			return;
+		}
+	}
+}
+
+// apply the register writes made since the last access, at the time of that
+// access, then run the SPI up to now
+static void sync(void){
+	advance(lastAccess);
+	if (regs.SPIFFTX.all != shownFftx) {
+		fftx = regs.SPIFFTX.all & FFTX_WR;
+		if (!(fftx & TXFIFO)) txCount = 0;
+	}
+	if (regs.SPIFFRX.all != shownFfrx) {
+		if (regs.SPIFFRX.all & RXFFOVFCLR) ffrx &= ~RXFFOVF;
+		ffrx = (ffrx & RXFFOVF) | (regs.SPIFFRX.all & FFRX_WR);
+		if (!(ffrx & RXFIFORESET)) rxCount = 0;
+	}
+	if (txPending) {
+		txPending = 0;
+		if (fftx & SPIFFENA) {
+			if (!(fftx & TXFIFO) || (txCount == SPI_BUS_SIM_FIFO)) {
+				spiBusSim_txLost++;
+			} else {
+				txFifo[(txHead + txCount) % SPI_BUS_SIM_FIFO] = txSlot;
+				txCount++;
+			}
+		} else {
+			if (txBufFull) spiBusSim_txLost++;
+			txBuf = txSlot;
+			txBufFull = 1;
+		}
+	}
+	advance(spiBusSim_cycles);
+
+	regs.SPISTS.all = (overrun ? OVERRUN_FLAG : 0) | (intFlag ? INT_FLAG : 0) | (txBufFull ? BUFFULL_FLAG : 0);
+	regs.SPIFFTX.all = shownFftx = fftx | (txCount << 8);
+	regs.SPIFFRX.all = shownFfrx = ffrx | (rxCount << 8);
+	lastAccess = spiBusSim_cycles;
+}
+
+void spiBusSim_idle(void){
+	sync();
+	advance(1e300);
+	if (spiBusSim_cycles < shiftEnd) spiBusSim_cycles = shiftEnd;
+	sync();
+}
+
+volatile struct SPI_REGS* spiBusSim_regs(void){
+	sync();
+	if (shifting || txBufFull || (txCount > 0)) {
+		idlePolls = 0;
+	} else if (++idlePolls > IDLE_POLLS) {
+		printf("FAIL: SPI idle for %ld register accesses, the firmware is waiting on a word that will not come (SpiBusSim.c)\n", IDLE_POLLS);
+		exit(2);
+	}
+	spiBusSim_cycles += spiBusSim_cyclesPerAccess;
+	if (spiBusSim_isrEvery && (++accesses % spiBusSim_isrEvery == 0)) {
+		spiBusSim_cycles += spiBusSim_isrCycles;
+	}
+	return &regs;
+}
+
+volatile Uint16* spiBusSim_txBuf(void){
+	sync();
+	txPending = 1;
+	txSlot.at = spiBusSim_cycles;
+	return &txSlot.data;
+}
+
+Uint16 spiBusSim_rxBuf(void){
+	Uint16 w;
+
+	sync();
+	if (fftx & SPIFFENA) {
+		if (rxCount == 0) {
+			spiBusSim_emptyReads++;
+			return 0;
+		}
+		w = rxFifo[rxHead];
+		rxHead = (rxHead + 1) % SPI_BUS_SIM_FIFO;
+		rxCount--;
+	} else {
+		w = rxBuf;
+		intFlag = 0;
+	}
+	regs.SPISTS.all &= ~INT_FLAG;
+	regs.SPIFFRX.all = shownFfrx = ffrx | (rxCount << 8);
+	return w;
+}
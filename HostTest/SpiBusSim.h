@@ -0,0 +1,75 @@
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+//
+//     SpiBusSim.h
+//
+// The DSP's SPI-A, at the register level, with an M25P40 FLASH on the bus,
+// for the host tests that link SPI.C.  A test built with
+//     -include SpiBusSim.h
+// sends every SpiaRegs access through spiBusSim_regs(), a write to
+// SPITXBUF through spiBusSim_txBuf() and a read of SPIRXBUF through
+// spiBusSim_rxBuf() (the macros below), so the SPI sees each word written
+// and read, in time order, as the hardware would.
+//  - time in CPU cycles, 150MHz; each access takes spiBusSim_cyclesPerAccess
+//    and an "interrupt" stalls the CPU spiBusSim_isrCycles every
+//    spiBusSim_isrEvery accesses
+//  - the bit clock is LSPCLK (75MHz) / (SPIBRR + 1), a character is
+//    SPICHAR + 1 bits, sent MS bit first from the top of SPITXBUF
+//  - without the FIFO enhancements (SPIFFTX.SPIFFENA = 0): SPITXBUF, one
+//    shift register, SPIRXBUF; INT_FLAG set at the end of each character
+//    and cleared by reading SPIRXBUF; a character that ends with INT_FLAG
+//    still set overwrites SPIRXBUF, an overrun
+//  - with them: 16-word transmit and receive FIFOs, each held empty while
+//    its FIFO reset bit is 0; a character that ends with the receive FIFO
+//    full is lost, an overrun (RXFFOVF); a write to a full transmit FIFO is
+//    lost too
+// The FLASH is selected when SelectSpiFlash() asks frw_GetWhichFlash()
+// which one to select: the test supplies that, and calls spiBusSim_select().
+// It takes READ (0x03, up to 20MHz), FAST_READ (0x0B and a dummy byte, up
+// to 25MHz) and the status register read (0x05); anything else it ignores.
+// SPISTS is status only here: the firmware's writes to it are not modelled.
+// Firmware that keeps polling an idle SPI, waiting for a word that was lost,
+// ends the test with a FAIL.
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+#ifndef SPIBUSSIM_H
+#define SPIBUSSIM_H
+
+#include "DSP281x_Device.h"
+
+#define SPI_BUS_SIM_BYTES  0x80000L
+#define SPI_BUS_SIM_FIFO   16
+
+extern unsigned char spiBusSim_mem[SPI_BUS_SIM_BYTES];
+extern double spiBusSim_cycles;
+extern double spiBusSim_cyclesPerAccess;
+extern long spiBusSim_isrEvery;			// an "interrupt" of spiBusSim_isrCycles every
+extern double spiBusSim_isrCycles;		// so many accesses, 0 = none
+extern Uint16 spiBusSim_status;			// the FLASH status register
+
+extern long spiBusSim_overruns;			// characters lost on the receive side
+extern long spiBusSim_txLost;			// words written to a full transmit FIFO
+extern long spiBusSim_emptyReads;		// SPIRXBUF read with nothing received
+extern long spiBusSim_clockErrors;		// commands clocked faster than the FLASH allows
+extern int spiBusSim_maxRxFifo;			// most words the receive FIFO has held
+extern long spiBusSim_words;			// characters shifted
+extern long spiBusSim_dataBytes;		// bytes the FLASH sent as READ / FAST_READ data
+extern double spiBusSim_busyCycles;		// cycles the shift register was shifting
+
+// FLASH all 0xFF, SPI idle, FIFO enhancements off, counts zeroed, time 0
+void spiBusSim_reset(void);
+
+// chip select: the FLASH starts a new command with the next byte
+void spiBusSim_select(void);
+
+volatile struct SPI_REGS* spiBusSim_regs(void);
+volatile Uint16* spiBusSim_txBuf(void);
+Uint16 spiBusSim_rxBuf(void);
+
+// run the SPI until it has shifted everything written to it
+void spiBusSim_idle(void);
+
+#define SpiaRegs (*spiBusSim_regs())
+#define SPITXBUF SPITXBUF, *spiBusSim_txBuf()
+#define SPIRXBUF SPIRXBUF * 0 + spiBusSim_rxBuf()
+
+#endif
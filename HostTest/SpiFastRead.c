@@ -0,0 +1,159 @@
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+//
+//     SpiFastRead.c
+//
+// Host test for the FAST_READ burst in SPI.C, spi_FastReadBurst() through
+// the 16-word SPI FIFOs, against the SPI-A registers and FLASH simulated
+// in SpiBusSim.c.
+//  1. spi_ReadFlash(), 1 to 2048 words from anywhere in the FLASH, at
+//     every cost of a register access, with and without "interrupts" --
+//     short ones, and ones long enough for the SPI to shift 16 words and
+//     more while the CPU is away: every word read in FLASH order, no
+//     receive overrun, no word lost in the transmit FIFO, no read of an
+//     empty receive FIFO, no command clocked faster than the FLASH takes
+//     it, and a status read by xfer_16() right after still works
+//  2. spi_ClockFlashToFpgaStart() and 4096-byte spi_ClockFlashToFpga()
+//     blocks, as frw_SpiFlashTask() clocks a bitstream into an FPGA: every
+//     byte clocked out of the FLASH, none lost
+//  3. the rate: a 4096-byte block keeps the SPI shifting 90% of the time
+//     or more, and takes under 2 mSec
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "DSP281x_Device.h"
+#include "stdbool.h"
+#include "SPI.H"
+#include "FlashRW.H"
+#include "SpiBusSim.h"
+
+#define CYCLES_PER_US 150.0
+#define BLOCK_WORDS 2048		// BITSTREAM_BLOCKSIZE in FlashRW.C, in words
+
+static int fails;
+#define CHECK(c, ...) do { if (!(c)) { printf("FAIL %s:%d ", __FILE__, __LINE__); \
+	printf(__VA_ARGS__); printf("\n"); fails++; if (fails > 10) exit(1); } } while (0)
+
+// SelectSpiFlash() asks which FLASH to select, as it selects it
+Uint16 frw_GetWhichFlash(void){
+	spiBusSim_select();
+	return 1;
+}
+
+static void fillFlash(void){
+	long i;
+
+	for (i = 0; i < SPI_BUS_SIM_BYTES; i++){
+		spiBusSim_mem[i] = rand();
+	}
+}
+
+static void setAddress(Uint16* address, Uint32 a){
+	address[0] = a & 0xFFFF;
+	address[1] = (a >> 16) & 0x00FF;
+}
+
+static void noErrors(const char* what){
+	CHECK(spiBusSim_overruns == 0, "%s: %ld receive overruns", what, spiBusSim_overruns);
+	CHECK(spiBusSim_txLost == 0, "%s: %ld words lost in the transmit FIFO", what, spiBusSim_txLost);
+	CHECK(spiBusSim_emptyReads == 0, "%s: %ld reads of an empty receive FIFO", what, spiBusSim_emptyReads);
+	CHECK(spiBusSim_clockErrors == 0, "%s: clocked faster than the FLASH takes", what);
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// 1. spi_ReadFlash()
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+static void readFlash(void){
+	static const Uint16 counts[] = {1, 2, 15, 16, 17, 31, 33, 100, 256, BLOCK_WORDS};
+	static const double accessCost[] = {2, 4, 8, 16};
+	static const struct { long every; double cycles; } isr[] = {{0, 0}, {5, 300}, {37, 20000}};
+	static Uint16 buf[BLOCK_WORDS + 1];
+	Uint16 address[2];
+	Uint32 a;
+	unsigned c, k, n, i;
+	long reads = 0;
+	char what[80];
+
+	for (k = 0; k < sizeof isr / sizeof isr[0]; k++){
+		for (c = 0; c < sizeof accessCost / sizeof accessCost[0]; c++){
+			spiBusSim_reset();
+			fillFlash();
+			spiBusSim_cyclesPerAccess = accessCost[c];
+			spiBusSim_isrEvery = isr[k].every;
+			spiBusSim_isrCycles = isr[k].cycles;
+			InitSpi();
+			sprintf(what, "access %.0f cycles, interrupt %.0f cycles every %ld", accessCost[c], isr[k].cycles, isr[k].every);
+			for (n = 0; n < sizeof counts / sizeof counts[0]; n++){
+				a = (Uint32)rand() % (SPI_BUS_SIM_BYTES - 2L * counts[n]);
+				setAddress(address, a);
+				buf[counts[n]] = 0x5A5A;
+				spi_ReadFlash(address, counts[n], buf);
+				for (i = 0; i < counts[n]; i++){
+					Uint16 want = (spiBusSim_mem[a + 2L * i] << 8) | spiBusSim_mem[a + 2L * i + 1];
+					if (buf[i] != want) {
+						CHECK(0, "%s: %u words at %05lX: word %u is %04X, FLASH has %04X", what, counts[n], (unsigned long)a, i, buf[i], want);
+						break;
+					}
+				}
+				CHECK(buf[counts[n]] == 0x5A5A, "%s: %u words read, more written", what, counts[n]);
+
+				spiBusSim_status = rand() & 0x00FF;
+				CHECK((spi_ReadSpiFlashStatus() & 0x00FF) == spiBusSim_status, "%s: status read after the burst", what);
+				reads++;
+			}
+			noErrors(what);
+			CHECK(spiBusSim_maxRxFifo <= SPI_BUS_SIM_FIFO, "%s", what);
+		}
+	}
+	printf("spi_ReadFlash: %ld reads, no overruns\n", reads);
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// 2., 3. clocking a bitstream out
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+static void clockToFpga(void){
+	static const struct { long every; double cycles; } isr[] = {{0, 0}, {11, 3000}, {53, 40000}};
+	Uint16 address[2];
+	unsigned k, b;
+	double t, busy, us, slowest = 0, leastBusy = 1;
+
+	for (k = 0; k < sizeof isr / sizeof isr[0]; k++){
+		spiBusSim_reset();
+		spiBusSim_isrEvery = isr[k].every;
+		spiBusSim_isrCycles = isr[k].cycles;
+		InitSpi();
+		setAddress(address, 0);
+		spi_ClockFlashToFpgaStart(address);
+		spiBusSim_idle();
+		for (b = 0; b < 64; b++){
+			t = spiBusSim_cycles;
+			busy = spiBusSim_busyCycles;
+			spi_ClockFlashToFpga(BLOCK_WORDS);
+			spiBusSim_idle();
+			if (isr[k].every == 0) {
+				us = (spiBusSim_cycles - t) / CYCLES_PER_US;
+				if (us > slowest) slowest = us;
+				if ((spiBusSim_busyCycles - busy) / (spiBusSim_cycles - t) < leastBusy) {
+					leastBusy = (spiBusSim_busyCycles - busy) / (spiBusSim_cycles - t);
+				}
+			}
+		}
+		spi_disableAllSpiDevices();
+		CHECK(spiBusSim_dataBytes == 64L * 2 * BLOCK_WORDS, "%ld bytes clocked out, not %ld",
+			spiBusSim_dataBytes, 64L * 2 * BLOCK_WORDS);
+		noErrors("spi_ClockFlashToFpga");
+	}
+	CHECK(leastBusy >= 0.9, "SPI shifting %.0f%% of a block", 100 * leastBusy);
+	CHECK(slowest < 2000, "%.0f uSec a block", slowest);
+	printf("spi_ClockFlashToFpga: %d bytes in %.0f uSec, SPI shifting %.0f%% of it\n",
+		2 * BLOCK_WORDS, slowest, 100 * leastBusy);
+}
+
+int main(void){
+	srand(12);
+	readFlash();
+	clockToFpga();
+	printf(fails ? "FAIL (%d)\n" : "PASS\n", fails);
+	return fails != 0;
+}
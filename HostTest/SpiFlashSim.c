@@ -0,0 +1,143 @@
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+//
+//     SpiFlashSim.c
+//
+// See SpiFlashSim.h.
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+#include <string.h>
+
+#include "DSP281x_Device.h"
+#include "SPI.H"
+#include "SpiFlashSim.h"
+
+#define WIP 0x01
+#define WEL 0x02
+
+unsigned char spiFlashSim_mem[SPI_FLASH_SIM_BYTES];
+long spiFlashSim_pagePrograms;
+long spiFlashSim_errors;
+long spiFlashSim_statusReads;
+long spiFlashSim_sectorErases;
+long spiFlashSim_bulkErases;
+int spiFlashSim_busyPolls = 2;
+double spiFlashSim_us;
+double spiFlashSim_tppUs;
+double spiFlashSim_tseUs;
+double spiFlashSim_tbeUs;
+
+static Uint16 status;
+static int busyLeft;
+static double busyUntil;		// < 0: busy for busyLeft status reads
+
+void spiFlashSim_reset(void){
+	memset(spiFlashSim_mem, 0xFF, sizeof spiFlashSim_mem);
+	spiFlashSim_pagePrograms = 0;
+	spiFlashSim_errors = 0;
+	spiFlashSim_statusReads = 0;
+	spiFlashSim_sectorErases = 0;
+	spiFlashSim_bulkErases = 0;
+	spiFlashSim_us = 0;
+	status = 0;
+	busyLeft = 0;
+	busyUntil = -1;
+}
+
+static Uint32 flashAddr(const Uint16* address){
+	return (((Uint32)(address[1] & 0x00FF) << 16) | address[0]) % SPI_FLASH_SIM_BYTES;
+}
+
+// a command other than a status read: refused while the chip is busy
+static int accepted(void){
+	if (status & WIP) {
+		spiFlashSim_errors++;
+		return 0;
+	}
+	return 1;
+}
+
+static void startBusy(double us){
+	status = (status & ~WEL) | WIP;
+	busyLeft = spiFlashSim_busyPolls;
+	busyUntil = (us > 0) ? spiFlashSim_us + us : -1;
+}
+
+Uint16 spi_ReadSpiFlashStatus(void){
+	Uint16 s;
+
+	spiFlashSim_statusReads++;
+	if ((status & WIP) && (busyUntil >= 0)) {
+		if (spiFlashSim_us >= busyUntil) status &= ~WIP;
+		return status;
+	}
+	s = status;
+	if ((status & WIP) && (--busyLeft <= 0)) {
+		status &= ~WIP;
+	}
+	return s;
+}
+
+void spi_SetFlashWriteEnable(void){
+	if (accepted()) status |= WEL;
+}
+
+void spi_disableAllSpiDevices(void){
+}
+
+bool spi_WriteFlash(Uint16* address, Uint16 countWordsToWrite, Uint16* sourceBuff){
+	Uint32 addr = flashAddr(address);
+	Uint32 page = addr & ~(Uint32)(SPI_FLASH_SIM_PAGE - 1);
+	Uint16 offset = addr & (SPI_FLASH_SIM_PAGE - 1);
+	Uint16 i;
+
+	if (!accepted()) return true;
+	if (!(status & WEL) || (countWordsToWrite > SPI_FLASH_SIM_PAGE / 2)) {
+		spiFlashSim_errors++;
+		return true;
+	}
+	for (i = 0; i < countWordsToWrite; i++){
+		spiFlashSim_mem[page + offset] &= sourceBuff[i] >> 8;
+		offset = (offset + 1) & (SPI_FLASH_SIM_PAGE - 1);
+		spiFlashSim_mem[page + offset] &= sourceBuff[i] & 0x00FF;
+		offset = (offset + 1) & (SPI_FLASH_SIM_PAGE - 1);
+	}
+	spiFlashSim_pagePrograms++;
+	startBusy(spiFlashSim_tppUs);
+	return true;
+}
+
+bool spi_ReadFlash(Uint16* address, Uint16 countWordsToRead, Uint16* destBuff){
+	Uint32 addr = flashAddr(address);
+	Uint16 i;
+
+	if (!accepted()) return true;
+	for (i = 0; i < countWordsToRead; i++){
+		destBuff[i] = (Uint16)spiFlashSim_mem[addr] << 8;
+		addr = (addr + 1) % SPI_FLASH_SIM_BYTES;
+		destBuff[i] |= spiFlashSim_mem[addr];
+		addr = (addr + 1) % SPI_FLASH_SIM_BYTES;
+	}
+	return true;
+}
+
+void spi_BulkEraseFlash(void){
+	if (!accepted()) return;
+	if (!(status & WEL)) {
+		spiFlashSim_errors++;
+		return;
+	}
+	memset(spiFlashSim_mem, 0xFF, sizeof spiFlashSim_mem);
+	spiFlashSim_bulkErases++;
+	startBusy(spiFlashSim_tbeUs);
+}
+
+void spi_SectorEraseFlash(Uint16* address){
+	if (!accepted()) return;
+	if (!(status & WEL)) {
+		spiFlashSim_errors++;
+		return;
+	}
+	memset(spiFlashSim_mem + (flashAddr(address) & ~(SPI_FLASH_SIM_SECTOR - 1)), 0xFF, SPI_FLASH_SIM_SECTOR);
+	spiFlashSim_sectorErases++;
+	startBusy(spiFlashSim_tseUs);
+}
@@ -0,0 +1,44 @@
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+//
+//     SpiFlashSim.h
+//
+// The M25P40 SPI flash as the host tests need it, at the level of the
+// SPI.C calls FlashRW.C makes (SPI.C itself is not linked): 512K bytes,
+// the 24-bit address in address[1] (MS byte) and address[0], 2 bytes per
+// word, MS byte first.  A page program clears bits only (1 -> 0), wraps
+// within its 256-byte page as the chip does, and needs the write enable
+// latch (WEL), which it and a sector or bulk erase clear.  After a program
+// or erase the status register shows write in progress (WIP) for the next
+// spiFlashSim_busyPolls reads of it -- or, when the test keeps time in
+// spiFlashSim_us and gives the chip's time for that operation (tPP, tSE,
+// tBE below), until that much later.  Commands the chip would ignore --
+// program or erase without WEL, anything but a status read while WIP --
+// are ignored and counted in spiFlashSim_errors.
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+#ifndef SPIFLASHSIM_H
+#define SPIFLASHSIM_H
+
+#define SPI_FLASH_SIM_BYTES 0x80000L
+#define SPI_FLASH_SIM_PAGE  0x100
+#define SPI_FLASH_SIM_SECTOR 0x10000L
+
+extern unsigned char spiFlashSim_mem[SPI_FLASH_SIM_BYTES];
+extern long spiFlashSim_pagePrograms;
+extern long spiFlashSim_errors;
+extern long spiFlashSim_statusReads;
+extern long spiFlashSim_sectorErases;
+extern long spiFlashSim_bulkErases;
+extern int spiFlashSim_busyPolls;
+
+// time, in uSec, and how long a page program, sector erase and bulk erase
+// keep the chip busy; 0 = spiFlashSim_busyPolls status reads instead
+extern double spiFlashSim_us;
+extern double spiFlashSim_tppUs;
+extern double spiFlashSim_tseUs;
+extern double spiFlashSim_tbeUs;
+
+// erased (all 0xFF), not busy, WEL clear, counts and time zeroed
+void spiFlashSim_reset(void);
+
+#endif
@@ -0,0 +1,196 @@
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+//
+//     TaskDelayWheel.c
+//
+// Host test for the task manager's timer wheel, ticked by hand in place of
+// timer0_miliSecTask().  A delayed task must become ready on exactly the
+// tick its delay runs out -- never early, never late:
+//  - delays of 0 (ready now) and 1, 63, 64, 65, 128, 129 ms and longer
+//  - a new delay replacing one in progress, a delay of 0 cancelling one
+//  - many tasks sharing a slot, the slot counter wrapping
+//  - random delays for every task, compared with a deadline per task,
+//    over a few million ticks
+//
+//     TaskDelayWheel [ticks]
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "DSP281x_Device.h"
+#include "TaskMgr.h"
+
+// TaskMgr.c internals
+extern Uint16 taskReadyFlags[MAX_TASKFLAG_WORDS];
+Uint16 taskMgr_firstSetTaskFlag();
+
+static int fails;
+#define CHECK(c, ...) do { if (!(c)) { printf("FAIL %s:%d ", __FILE__, __LINE__); \
+	printf(__VA_ARGS__); printf("\n"); fails++; } } while (0)
+
+static int isReady(Uint16 t){
+	return (taskReadyFlags[t >> 4] >> (t & 0x000F)) & 1;
+}
+
+// ticks until task t is ready, giving up after limit
+static long ticksUntilReady(Uint16 t, long limit){
+	long n;
+
+	for (n = 0; !isReady(t) && (n < limit); n++){
+		taskMgr_tickDelayWheel();
+	}
+	return n;
+}
+
+static void exactDelays(void){
+	static const Uint32 delays[] = {1, 2, 63, 64, 65, 127, 128, 129, 1000, 4095, 4096, 4097, 65536L, 100000L};
+	unsigned k;
+	long n, phase;
+
+	for (phase = 0; phase < 3; phase++){
+		for (k = 0; k < sizeof delays / sizeof delays[0]; k++){
+			taskMgr_init();
+			for (n = 0; n < phase * 37; n++){	// start at different slots
+				taskMgr_tickDelayWheel();
+			}
+			taskMgr_setTaskWithDelayMs(5, delays[k]);
+			CHECK(!isReady(5), "delay %lu: ready before any tick", (unsigned long)delays[k]);
+			n = ticksUntilReady(5, delays[k] + 10);
+			CHECK(n == (long)delays[k], "delay %lu: ready after %ld ticks", (unsigned long)delays[k], n);
+		}
+	}
+
+	taskMgr_init();
+	taskMgr_setTaskWithDelayMs(5, 0);
+	CHECK(isReady(5), "delay 0: not ready at once");
+	CHECK(taskMgr_firstSetTaskFlag() == 5, "delay 0: not dispatched");
+
+	taskMgr_setTaskWithDelay(6, 3);
+	n = ticksUntilReady(6, 1000);
+	CHECK(n == 300, "0.3 sec: ready after %ld ticks", n);
+}
+
+static void replaceAndCancel(void){
+	long n;
+
+	// a shorter delay replaces a longer one
+	taskMgr_init();
+	taskMgr_setTaskWithDelayMs(7, 500);
+	taskMgr_setTaskWithDelayMs(7, 10);
+	n = ticksUntilReady(7, 1000);
+	CHECK(n == 10, "500 then 10 ms: ready after %ld ticks", n);
+
+	// a longer one replaces a shorter one
+	taskMgr_init();
+	taskMgr_setTaskWithDelayMs(7, 10);
+	taskMgr_setTaskWithDelayMs(7, 500);
+	n = ticksUntilReady(7, 1000);
+	CHECK(n == 500, "10 then 500 ms: ready after %ld ticks", n);
+
+	// 0 cancels the delay
+	taskMgr_init();
+	taskMgr_setTaskWithDelayMs(7, 500);
+	taskMgr_setTaskWithDelayMs(7, 0);
+	CHECK(isReady(7), "500 then 0 ms: not ready at once");
+
+	// setTask() alone leaves a delay in progress alone
+	taskMgr_init();
+	taskMgr_setTaskWithDelayMs(7, 20);
+	taskMgr_setTask(7);
+	CHECK(!isReady(7), "setTask() cut a 20 ms delay short");
+	n = ticksUntilReady(7, 1000);
+	CHECK(n == 20, "20 ms then setTask(): ready after %ld ticks", n);
+
+	// a task that expires without having been requested does not run
+	taskMgr_init();
+	taskMgr_setTaskWithDelayMs(7, 5);
+	CHECK(taskMgr_firstSetTaskFlag() == MAX_NUMBER_OF_TASKS, "delayed task dispatched early");
+	n = ticksUntilReady(7, 100);
+	CHECK(n == 5, "5 ms: ready after %ld ticks", n);
+	CHECK(taskMgr_firstSetTaskFlag() == 7, "5 ms: not dispatched");
+	CHECK(taskMgr_firstSetTaskFlag() == MAX_NUMBER_OF_TASKS, "5 ms: dispatched twice");
+}
+
+// every task in one slot, some needing extra trips around the wheel; take
+// some out of the middle of the list
+static void sharedSlot(void){
+	Uint16 t;
+	long n;
+
+	taskMgr_init();
+	for (t = 0; t < MAX_NUMBER_OF_TASKS; t++){
+		taskMgr_setTaskWithDelayMs(t, 10 + 64L * (t % 4));
+	}
+	for (t = 10; t < MAX_NUMBER_OF_TASKS; t += 8){
+		taskMgr_setTaskWithDelayMs(t, 0);
+	}
+	for (n = 1; n <= 10 + 64 * 3; n++){
+		taskMgr_tickDelayWheel();
+		for (t = 0; t < MAX_NUMBER_OF_TASKS; t++){
+			long due = ((t >= 10) && ((t - 10) % 8 == 0)) ? 0 : 10 + 64L * (t % 4);
+
+			if (isReady(t) != (n >= due)) {
+				CHECK(0, "shared slot: task 0x%02X due at %ld, ready %d at tick %ld", t, due, isReady(t), n);
+				return;
+			}
+		}
+	}
+}
+
+// random delays, one deadline per task
+static void randomDelays(long ticks){
+	long now, due[MAX_NUMBER_OF_TASKS];
+	long requests = 0;
+	Uint16 t;
+	Uint32 d;
+
+	taskMgr_init();
+	srand(2);
+	for (t = 0; t < MAX_NUMBER_OF_TASKS; t++){
+		due[t] = -1;	// not requested
+	}
+	for (now = 0; now < ticks; now++){
+		if (rand() % 4 == 0) {
+			t = rand() % MAX_NUMBER_OF_TASKS;
+			switch (rand() % 4){
+			case 0: d = rand() % 4; break;
+			case 1: d = 60 + rand() % 10; break;
+			case 2: d = rand() % 300; break;
+			default: d = rand() % 5000; break;
+			}
+			taskMgr_setTaskWithDelayMs(t, d);
+			due[t] = now + d;
+			requests++;
+		}
+		// run a ready task now and then
+		if (rand() % 8 == 0) {
+			t = taskMgr_firstSetTaskFlag();
+			if (t < MAX_NUMBER_OF_TASKS) {
+				if (due[t] < 0 || due[t] > now) {
+					CHECK(0, "tick %ld: task 0x%02X dispatched, due at %ld", now, t, due[t]);
+					return;
+				}
+				due[t] = -1;
+			}
+		}
+		taskMgr_tickDelayWheel();
+		for (t = 0; t < MAX_NUMBER_OF_TASKS; t++){
+			if (isReady(t) != ((due[t] >= 0) && (due[t] <= now + 1))) {
+				CHECK(0, "tick %ld: task 0x%02X due at %ld, ready %d", now + 1, t, due[t], isReady(t));
+				return;
+			}
+		}
+	}
+	printf("random delays: %ld requests over %ld ticks\n", requests, ticks);
+}
+
+int main(int argc, char** argv){
+	long ticks = (argc > 1) ? atol(argv[1]) : 2000000L;
+
+	exactDelays();
+	replaceAndCancel();
+	sharedSlot();
+	randomDelays(ticks);
+	printf(fails ? "FAIL (%d)\n" : "PASS\n", fails);
+	return fails != 0;
+}
@@ -0,0 +1,297 @@
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+//
+//     TaskDispatch.c
+//
+// Host test and benchmark for the task dispatch in TaskMgr.c.
+//  - dispatch order: random setTask / setTaskWithDelay / setTaskRoundRobin /
+//    0.1 sec of timer wheel ticks, each dispatch compared with the old
+//    bit-by-bit scan of taskFlags[] and tenth-second taskDelays[] (copied
+//    below from the previous TaskMgr.c)
+//  - interrupts: an "ISR" calls taskMgr_setTask() between any two
+//    instructions of a background dispatch / setTask / wheel tick where
+//    interrupts are enabled.  The request must not be lost.
+//  - latency: TSC ticks per taskMgr_setTask() + taskMgr_firstSetTaskFlag(),
+//    against the old scan, with one task ready at various task numbers.  x86 ticks, only
+//    the shape of the numbers means anything for the C28x.
+//
+//     TaskDispatch [random steps]
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <x86intrin.h>
+
+#include "DSP281x_Device.h"
+#include "TaskMgr.h"
+#include "SingleStep.h"
+
+// TaskMgr.c internals
+extern Uint16 prevTaskNumber;
+extern enum TASK_SCHED_SCHEME schedulingScheme;
+extern Uint16 taskRoundRobinFlags[MAX_TASKFLAG_WORDS];
+Uint16 taskMgr_firstSetTaskFlag();
+
+static int fails;
+#define CHECK(c, ...) do { if (!(c)) { printf("FAIL %s:%d ", __FILE__, __LINE__); \
+	printf(__VA_ARGS__); printf("\n"); fails++; } } while (0)
+
+// what timer0_miliSecTask() does in 0.1 sec
+static void tenthOfSec(void){
+	int i;
+
+	for (i = 0; i < 100; i++){
+		taskMgr_tickDelayWheel();
+	}
+}
+
+// taskMgr_runBkgndTasks() without calling the task
+static Uint16 dispatch(void){
+	Uint16 taskNumber = taskMgr_firstSetTaskFlag();
+
+	prevTaskNumber = taskNumber;
+	if (taskNumber >= MAX_NUMBER_OF_TASKS) {
+		schedulingScheme = TASK_SCHED_PRIORITY;
+	}
+	return taskNumber;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// The old dispatcher, as it was in TaskMgr.c before the ready bitmap
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+static Uint16 oldTaskFlags[MAX_TASKFLAG_WORDS];
+static Uint16 oldTaskRoundRobinFlags[MAX_TASKFLAG_WORDS];
+static Uint16 oldTaskDelays[MAX_NUMBER_OF_TASKS];
+static Uint16 oldPrevTaskNumber = MAX_NUMBER_OF_TASKS;
+static enum TASK_SCHED_SCHEME oldSchedulingScheme;
+
+static void oldSetTask(Uint16 task_number){
+	oldTaskFlags[task_number >> 4] |= 0x0001 << (task_number & 0x000F);
+}
+
+static void oldSetTaskWithDelay(Uint16 task_number, Uint16 delayInSecTenths){
+	oldSetTask(task_number);
+	oldTaskDelays[task_number] = delayInSecTenths;
+}
+
+static void oldSetTaskRoundRobin(Uint16 task_number, Uint16 delayInSecTenths){
+	oldSetTaskWithDelay(task_number, delayInSecTenths);
+	oldTaskRoundRobinFlags[task_number >> 4] |= 0x0001 << (task_number & 0x000F);
+}
+
+static void oldAgeTaskDelays(void){
+	int i;
+	for (i = 0; i < MAX_NUMBER_OF_TASKS; i++){
+		if (oldTaskDelays[i] != 0) oldTaskDelays[i]--;
+	}
+}
+
+static Uint16 oldFirstSetTaskFlag(void){
+	Uint16 i,j;
+	Uint16 taskNumber=0;
+	Uint16 flags;
+	Uint16 shiftedBit;
+
+	for (i = 0; i < MAX_TASKFLAG_WORDS; i++){
+		flags = oldTaskFlags[i];
+		if (flags == 0) {
+			taskNumber += 16;
+			if (taskNumber >= MAX_NUMBER_OF_TASKS){
+				return taskNumber;
+			}
+			continue;
+		}
+		shiftedBit = 0x0001;
+		for (j = 0;j<16;j++){
+			if((flags & shiftedBit) && (oldTaskDelays[taskNumber] == 0)) {
+				if ((oldSchedulingScheme == TASK_SCHED_PRIORITY)
+				|| ((taskNumber > oldPrevTaskNumber) || (oldPrevTaskNumber >= MAX_NUMBER_OF_TASKS))) {
+					oldTaskFlags[i] ^= shiftedBit;
+					if (oldTaskRoundRobinFlags[i] & shiftedBit){
+						oldSchedulingScheme = TASK_SCHED_ROUNDROBIN;
+					}
+					return taskNumber;
+				}
+			}
+			taskNumber++;
+			shiftedBit <<= 1;
+		}
+		if (taskNumber >= MAX_NUMBER_OF_TASKS){
+			return taskNumber;
+		}
+	}
+	return taskNumber;
+}
+
+static Uint16 oldDispatch(void){
+	Uint16 taskNumber = oldFirstSetTaskFlag();
+
+	oldPrevTaskNumber = taskNumber;
+	if (taskNumber >= MAX_NUMBER_OF_TASKS) {
+		oldSchedulingScheme = TASK_SCHED_PRIORITY;
+	}
+	return taskNumber;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// 1. same dispatch order as the old scan
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+static void randomSequences(long steps){
+	long i;
+	Uint16 t, d, got, want;
+
+	taskMgr_init();
+	srand(1);
+	for (i = 0; i < steps; i++){
+		t = rand() % MAX_NUMBER_OF_TASKS;
+		d = rand() % 3;
+		switch (rand() % 8){
+		case 0:
+			taskMgr_setTask(t);
+			oldSetTask(t);
+			break;
+		case 1:
+			taskMgr_setTaskWithDelay(t, d);
+			oldSetTaskWithDelay(t, d);
+			break;
+		case 2:
+			if (rand() % 4) break; // keep round robin flags from piling up
+			taskMgr_setTaskRoundRobin(t, d);
+			oldSetTaskRoundRobin(t, d);
+			break;
+		case 3:
+			tenthOfSec();
+			oldAgeTaskDelays();
+			break;
+		default:
+			got = dispatch();
+			want = oldDispatch();
+			if (got != want) {
+				CHECK(got == want, "step %ld: dispatched %u, old scan %u", i, got, want);
+				return;
+			}
+			break;
+		}
+	}
+	printf("random sequences: %ld steps, same order as the old scan\n", steps);
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// 2. no request from an interrupt is lost
+// The background call runs single-stepped, and the "ISR" calls
+// taskMgr_setTask(isrTask) after instruction number "at", unless interrupts
+// are disabled there.  "at" walks every instruction of the call, so every
+// place the interrupt could land on the C28x gets its turn.
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+static Uint16 bkgndTask, isrTask;
+static Uint16 dispatched;
+
+static void isr(void){
+	taskMgr_setTask(isrTask);
+}
+
+// the background call under test
+static void callDispatch(void){ dispatched = dispatch(); }
+static void callSetTask(void){ taskMgr_setTask(bkgndTask + 1); }
+static void callSetDelay(void){ taskMgr_setTaskWithDelayMs(bkgndTask + 1, 0); }
+static void callTick(void){ taskMgr_tickDelayWheel(); }
+
+static const struct {
+	void (*fn)(void);
+	const char* name;
+} calls[] = {{callDispatch, "dispatch"}, {callSetTask, "setTask"},
+		{callSetDelay, "setTaskWithDelayMs"}, {callTick, "tickDelayWheel"}};
+
+static void interruptRace(void){
+	static const Uint16 pairs[][2] = {{3, 5}, {5, 3}, {3, 3}, {3, 20}, {20, 3}, {15, 16}, {0x2E, 0x2F}};
+	unsigned call, k;
+	long at, steps, points = 0;
+	int isrRan;
+	Uint16 t, seen;
+
+	for (call = 0; call < sizeof calls / sizeof calls[0]; call++){
+		for (k = 0; k < sizeof pairs / sizeof pairs[0]; k++){
+			bkgndTask = pairs[k][0];
+			isrTask = pairs[k][1];
+			for (at = 1; ; at++){
+				taskMgr_init();
+				taskMgr_setTask(bkgndTask);
+				if (calls[call].fn == callTick) {
+					taskMgr_setTaskWithDelayMs(bkgndTask, 1);
+				}
+				dispatched = MAX_NUMBER_OF_TASKS;
+				steps = singleStep_run(calls[call].fn, at, isr, &isrRan);
+				if (at > steps) break;
+				if (!isrRan) continue;
+				points++;
+				// under priority scheduling, everything requested comes out
+				schedulingScheme = TASK_SCHED_PRIORITY;
+				seen = (dispatched == isrTask);
+				while ((t = dispatch()) < MAX_NUMBER_OF_TASKS) {
+					if (t == isrTask) seen = 1;
+				}
+				if (!seen) {
+					CHECK(seen, "%s(0x%02X): taskMgr_setTask(0x%02X) from an interrupt after instruction %ld was lost",
+						calls[call].name, bkgndTask, isrTask, at);
+					break;
+				}
+			}
+		}
+	}
+	printf("interrupts: taskMgr_setTask() from an ISR at %ld points inside background calls\n", points);
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// 3. latency with one task ready, at task number t: set it and dispatch it,
+// LATENCY_ROUNDS times
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+#define LATENCY_ROUNDS 2000000
+
+static double ticksNew(Uint16 t){
+	unsigned long long t0;
+	long i;
+
+	t0 = __rdtsc();
+	for (i = 0; i < LATENCY_ROUNDS; i++){
+		if (t < MAX_NUMBER_OF_TASKS) taskMgr_setTask(t);
+		dispatch();
+	}
+	return (double)(__rdtsc() - t0) / LATENCY_ROUNDS;
+}
+
+static double ticksOld(Uint16 t){
+	unsigned long long t0;
+	long i;
+
+	t0 = __rdtsc();
+	for (i = 0; i < LATENCY_ROUNDS; i++){
+		if (t < MAX_NUMBER_OF_TASKS) oldSetTask(t);
+		oldDispatch();
+	}
+	return (double)(__rdtsc() - t0) / LATENCY_ROUNDS;
+}
+
+static void latency(void){
+	static const Uint16 tasks[] = {0, 7, 15, 16, 31, 32, MAX_NUMBER_OF_TASKS - 1, MAX_NUMBER_OF_TASKS};
+	unsigned k;
+
+	taskMgr_init();
+	printf("TSC ticks per set + dispatch of one task\n");
+	printf("  task     new    old\n");
+	for (k = 0; k < sizeof tasks / sizeof tasks[0]; k++){
+		if (tasks[k] < MAX_NUMBER_OF_TASKS) {
+			printf("  0x%02X  %6.1f %6.1f\n", tasks[k], ticksNew(tasks[k]), ticksOld(tasks[k]));
+		} else {
+			printf("  none  %6.1f %6.1f\n", ticksNew(tasks[k]), ticksOld(tasks[k]));
+		}
+	}
+}
+
+int main(int argc, char** argv){
+	long steps = (argc > 1) ? atol(argv[1]) : 5000000L;
+
+	randomSequences(steps);
+	interruptRace();
+	latency();
+	printf(fails ? "FAIL (%d)\n" : "PASS\n", fails);
+	return fails != 0;
+}
@@ -0,0 +1,164 @@
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+//
+//     TaskProfile.c
+//
+// Host test for the task manager's execution time profiler
+// (TASKMGR_ENABLE_PROFILE).  timer0_freeRunStamp() is replaced by a
+// simulated cycle counter, and three tasks in task_vectors[] by stand-ins
+// that each "run" for a chosen number of cycles.  Call count, average and
+// worst case are compared with statistics kept here in double precision,
+// including runs where the 32-bit counter wraps mid-task, and are read
+// back through the CAN 0x2059 handlers and the RS232 C1021 report.
+//
+//     TaskProfile [dispatches]
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "DSP281x_Device.h"
+#include "stdbool.h"
+#include "TaskMgr.h"
+
+static int fails;
+#define CHECK(c, ...) do { if (!(c)) { printf("FAIL %s:%d ", __FILE__, __LINE__); \
+	printf(__VA_ARGS__); printf("\n"); fails++; } } while (0)
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// simulated CPU-Timer 1 and the tasks being timed
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+static Uint32 simCycles;
+static Uint32 nextRunCycles;	// how long the next task "runs"
+
+Uint32 timer0_freeRunStamp(void){
+	return simCycles;
+}
+
+static void runFor(void){
+	simCycles += nextRunCycles;
+}
+
+// three tasks from task_vectors[]
+#define TASK_A 0x04
+#define TASK_B 0x05
+#define TASK_C 0x12
+void timer0_task(void){ runFor(); }
+void f1i_BgTask(void){ runFor(); }
+void rs232_commandDecode(void){ runFor(); }
+
+static const Uint16 profiled[] = {TASK_A, TASK_B, TASK_C};
+#define NUM_PROFILED (sizeof profiled / sizeof profiled[0])
+
+// reference statistics
+static struct {
+	double calls, total, worst;
+} ref[MAX_NUMBER_OF_TASKS];
+
+// the RS232 report
+static char report[200];
+bool r232Out_outChars(char* outChars, int charLength){
+	memcpy(report, outChars, charLength);
+	report[charLength] = 0;
+	return true;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// read one task's numbers through CAN 0x2059
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+static Uint32 canRead32(enum CANOPEN_STATUS (*send)(const struct CAN_COMMAND*, Uint16*)){
+	Uint16 mbox[4] = {0, 0, 0, 0};
+	enum CANOPEN_STATUS status;
+
+	status = send(NULL, mbox);
+	CHECK(status == CANOPEN_NO_ERR, "CAN 0x2059 read returned %d", status);
+	return ((Uint32)mbox[3] << 16) | mbox[2];
+}
+
+static void checkTask(Uint16 t){
+	double avg = ref[t].calls ? floor(ref[t].total / ref[t].calls) : 0;
+	Uint32 calls, avgCycles, worst;
+	char expect[200];
+
+	taskMgr_profileTaskNumber = t;
+	calls = canRead32(taskMgr_sendProfileCallCount);
+	avgCycles = canRead32(taskMgr_sendProfileAvgCycles);
+	worst = canRead32(taskMgr_sendProfileWorstCycles);
+	CHECK(calls == ref[t].calls, "task 0x%02X: %lu calls, expected %.0f", t, (unsigned long)calls, ref[t].calls);
+	CHECK(avgCycles == avg, "task 0x%02X: avg %lu cycles, expected %.0f", t, (unsigned long)avgCycles, avg);
+	CHECK(worst == ref[t].worst, "task 0x%02X: worst %lu cycles, expected %.0f", t, (unsigned long)worst, ref[t].worst);
+
+	report[0] = 0;
+	taskMgr_displayProfile(t);
+	sprintf(expect, "Task 0x%02X calls %.0f avg %.0f max %.0f cyc\n\r", t, ref[t].calls, avg, ref[t].worst);
+	CHECK(strcmp(report, expect) == 0, "C1021 report \"%s\", expected \"%s\"", report, expect);
+}
+
+static void checkAll(void){
+	Uint16 mbox[4] = {0, 0, 0, 0};
+	Uint16 t, worstTask = 0;
+	unsigned k;
+
+	for (k = 0; k < NUM_PROFILED; k++){
+		checkTask(profiled[k]);
+	}
+	for (t = 1; t < MAX_NUMBER_OF_TASKS; t++){
+		if (ref[t].worst > ref[worstTask].worst) worstTask = t;
+	}
+	taskMgr_sendProfileWorstTask(NULL, mbox);
+	CHECK(mbox[2] == worstTask, "worst task 0x%02X, expected 0x%02X", mbox[2], worstTask);
+	CHECK(mbox[3] == ((ref[worstTask].worst > 0xFFFFFF) ? 0xFFFF : (Uint16)((Uint32)ref[worstTask].worst >> 8)),
+		"worst task time %u * 256 cycles, expected %.0f cycles", mbox[3], ref[worstTask].worst);
+
+	taskMgr_profileTaskNumber = MAX_NUMBER_OF_TASKS;
+	CHECK(taskMgr_sendProfileCallCount(NULL, mbox) == CANOPEN_TASKMGR_001_ERR, "bad task number accepted");
+}
+
+static void dispatchOne(Uint16 t, Uint32 cycles){
+	nextRunCycles = cycles;
+	taskMgr_setTask(t);
+	taskMgr_runBkgndTasks();
+	ref[t].calls++;
+	ref[t].total += cycles;
+	if (cycles > ref[t].worst) ref[t].worst = cycles;
+}
+
+int main(int argc, char** argv){
+	long n = (argc > 1) ? atol(argv[1]) : 1000000L;
+	long i;
+	unsigned k;
+	Uint16 mbox[4];
+
+	taskMgr_init();
+
+	// nothing run yet
+	checkAll();
+
+	// fixed cases: 0 cycles, a task that runs across the counter wrapping
+	simCycles = 0xFFFFFF00L;
+	dispatchOne(TASK_A, 0x200);
+	dispatchOne(TASK_A, 0);
+	dispatchOne(TASK_B, 0x01000000L);	// saturates the worst task report
+	checkAll();
+
+	// random run times, large totals (past 2^32 cycles per task)
+	srand(3);
+	for (i = 0; i < n; i++){
+		k = rand() % NUM_PROFILED;
+		dispatchOne(profiled[k], (rand() % 8 == 0) ? (Uint32)rand() * 16 : (Uint32)(rand() % 5000));
+		simCycles += rand() % 100;	// background overhead between tasks
+	}
+	checkAll();
+
+	// reset over CAN
+	taskMgr_recvProfileReset(NULL, mbox);
+	memset(ref, 0, sizeof ref);
+	checkAll();
+	dispatchOne(TASK_C, 1234);
+	checkAll();
+
+	printf("profiled %ld dispatches of %u tasks\n", n + 4, (unsigned)NUM_PROFILED);
+	printf(fails ? "FAIL (%d)\n" : "PASS\n", fails);
+	return fails != 0;
+}
@@ -0,0 +1 @@
+// DSP281x_DefaultISR.h  (HostTest stand-in, intentionally empty)
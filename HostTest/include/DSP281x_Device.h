@@ -0,0 +1,69 @@
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+//
+//     DSP281x_Device.h  (HostTest stand-in)
+//
+// Just enough of TI's device header to build the firmware modules with gcc
+// on a PC.  Uint16/Uint32 keep their C28x widths; char is 8 bits here, see
+// the Makefile.  The peripheral register files are ordinary variables,
+// defined in HostRegs.c.  The TI peripheral headers the repo carries are
+// used as they are; the PIE ones, which it does not carry, are cut-down
+// stand-ins in this directory.
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+#ifndef DSP281x_DEVICE_H
+#define DSP281x_DEVICE_H
+
+typedef short          int16;
+typedef int            int32;
+typedef unsigned short Uint16;
+typedef unsigned int   Uint32;
+typedef float          float32;
+typedef long double    float64;
+
+#define interrupt
+#define cregister
+#define far
+#define EALLOW
+#define EDIS
+#define EINT
+#define DINT
+#define ESTOP0
+
+// CPU interrupt enable and flag registers, and their bits
+extern volatile Uint16 IER;
+extern volatile Uint16 IFR;
+#define M_INT1  0x0001
+#define M_INT2  0x0002
+#define M_INT3  0x0004
+#define M_INT4  0x0008
+#define M_INT5  0x0010
+#define M_INT6  0x0020
+#define M_INT7  0x0040
+#define M_INT8  0x0080
+#define M_INT9  0x0100
+#define M_INT10 0x0200
+#define M_INT11 0x0400
+#define M_INT12 0x0800
+#define M_INT13 0x1000
+#define M_INT14 0x2000
+
+// XINTF zone 2 (CPLD and FPGA registers), plain memory in HostRegs.c; the
+// CPLD.H address macros point into it (HDR_SED in the Makefile)
+#define HOST_XINTF_WORDS 0x100000L
+extern volatile Uint16 hostXintf[HOST_XINTF_WORDS];
+
+// compiler intrinsics, HostRegs.c has defaults a test can replace
+Uint16 __disable_interrupts(void);
+void __restore_interrupts(Uint16 intState);
+
+#include "DSP281x_SysCtrl.h"
+#include "DSP281x_CpuTimers.h"
+#include "DSP281x_ECan.h"
+#include "DSP281x_Gpio.h"
+#include "DSP281x_Spi.h"
+#include "DSP281x_Xintf.h"
+#include "DSP281x_XIntrupt.h"
+#include "DSP281x_PieCtrl.h"
+#include "DSP281x_PieVect.h"
+
+#endif  // end of DSP281x_DEVICE_H definition
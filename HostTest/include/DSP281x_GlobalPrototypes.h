@@ -0,0 +1,17 @@
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+//
+//     DSP281x_GlobalPrototypes.h  (HostTest stand-in)
+//
+// The TI support functions the firmware calls.  FwStubs.c has stand-ins.
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+#ifndef DSP281x_GLOBALPROTOTYPES_H
+#define DSP281x_GLOBALPROTOTYPES_H
+
+void InitECan(void);
+void InitPieCtrl(void);
+void InitPieVectTable(void);
+void InitSysCtrl(void);
+void DSP28x_usDelay(Uint32 Count);
+
+#endif  // end of DSP281x_GLOBALPROTOTYPES_H definition
@@ -0,0 +1,75 @@
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+//
+//     DSP281x_PieCtrl.h  (HostTest stand-in)
+//
+// The PIE control registers the firmware touches, laid out as in TI's
+// header, plus the PIEACK group bits.
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+#ifndef DSP281x_PIE_CTRL_H
+#define DSP281x_PIE_CTRL_H
+
+struct PIEIER_BITS {
+	Uint16 INTx1:1;
+	Uint16 INTx2:1;
+	Uint16 INTx3:1;
+	Uint16 INTx4:1;
+	Uint16 INTx5:1;
+	Uint16 INTx6:1;
+	Uint16 INTx7:1;
+	Uint16 INTx8:1;
+	Uint16 rsvd:8;
+};
+
+union PIEIER_REG {
+	Uint16             all;
+	struct PIEIER_BITS bit;
+};
+
+struct PIECTRL_BITS {
+	Uint16 ENPIE:1;
+	Uint16 PIEVECT:15;
+};
+
+union PIECTRL_REG {
+	Uint16              all;
+	struct PIECTRL_BITS bit;
+};
+
+union PIEACK_REG {
+	Uint16 all;
+};
+
+struct PIE_CTRL_REGS {
+	union PIECTRL_REG PIECRTL;
+	union PIEACK_REG  PIEACK;
+	union PIEIER_REG  PIEIER1;
+	union PIEIER_REG  PIEIER2;
+	union PIEIER_REG  PIEIER3;
+	union PIEIER_REG  PIEIER4;
+	union PIEIER_REG  PIEIER5;
+	union PIEIER_REG  PIEIER6;
+	union PIEIER_REG  PIEIER7;
+	union PIEIER_REG  PIEIER8;
+	union PIEIER_REG  PIEIER9;
+	union PIEIER_REG  PIEIER10;
+	union PIEIER_REG  PIEIER11;
+	union PIEIER_REG  PIEIER12;
+};
+
+#define PIEACK_GROUP1   0x0001
+#define PIEACK_GROUP2   0x0002
+#define PIEACK_GROUP3   0x0004
+#define PIEACK_GROUP4   0x0008
+#define PIEACK_GROUP5   0x0010
+#define PIEACK_GROUP6   0x0020
+#define PIEACK_GROUP7   0x0040
+#define PIEACK_GROUP8   0x0080
+#define PIEACK_GROUP9   0x0100
+#define PIEACK_GROUP10  0x0200
+#define PIEACK_GROUP11  0x0400
+#define PIEACK_GROUP12  0x0800
+
+extern volatile struct PIE_CTRL_REGS PieCtrlRegs;
+
+#endif  // end of DSP281x_PIE_CTRL_H definition
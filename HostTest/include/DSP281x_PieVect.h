@@ -0,0 +1,27 @@
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+//
+//     DSP281x_PieVect.h  (HostTest stand-in)
+//
+// The PIE vectors the firmware installs.  Unlike TI's table these are in
+// no particular order; nothing here dispatches through them.
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+#ifndef DSP281x_PIE_VECT_H
+#define DSP281x_PIE_VECT_H
+
+typedef interrupt void(*PINT)(void);
+
+struct PIE_VECT_TABLE {
+	PINT XINT13;
+	PINT XINT1;
+	PINT TINT0;
+	PINT T4PINT;
+	PINT RXAINT;
+	PINT TXAINT;
+	PINT ECAN0INTA;
+	PINT ECAN1INTA;
+};
+
+extern struct PIE_VECT_TABLE PieVectTable;
+
+#endif  // end of DSP281x_PIE_VECT_H definition
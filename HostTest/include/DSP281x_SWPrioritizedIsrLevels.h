@@ -0,0 +1 @@
+// DSP281x_SWPrioritizedIsrLevels.h  (HostTest stand-in, intentionally empty)
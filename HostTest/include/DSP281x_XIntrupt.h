@@ -0,0 +1,36 @@
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+//
+//     DSP281x_XIntrupt.h  (HostTest stand-in)
+//
+// The external interrupt control registers, laid out as in TI's header.
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+#ifndef DSP281x_XINTRUPT_H
+#define DSP281x_XINTRUPT_H
+
+struct XINTCR_BITS {
+	Uint16 ENABLE:1;
+	Uint16 SELECT:1;
+	Uint16 POLARITY:1;
+	Uint16 rsvd1:13;
+};
+
+union XINTCR_REG {
+	Uint16             all;
+	struct XINTCR_BITS bit;
+};
+
+struct XINTRUPT_REGS {
+	union XINTCR_REG XINT1CR;
+	union XINTCR_REG XINT2CR;
+	Uint16           rsvd1[5];
+	union XINTCR_REG XNMICR;
+	Uint16           XINT1CTR;
+	Uint16           XINT2CTR;
+	Uint16           rsvd[5];
+	Uint16           XNMICTR;
+};
+
+extern volatile struct XINTRUPT_REGS XIntruptRegs;
+
+#endif  // end of DSP281x_XINTRUPT_H definition
@@ -18,12 +18,30 @@
 #define I2CEE_WP_ON  true
 #define I2CEE_WP_OFF false
 
+// 24LC01B & 24LC02B both have an 8-byte page write buffer -- the most we can
+// write in one write cycle.  Page writes must not cross an 8-byte boundary.
+#define I2CEE_PAGE_SIZE 8
+// Acknowledge polling while the EEProm finishes a write cycle (tWR 5 mSec max):
+// poll every I2CEE_ACK_POLL_PERIOD_MS, give up after I2CEE_ACK_POLL_LIMIT polls.
+#define I2CEE_ACK_POLL_PERIOD_MS 1
+#define I2CEE_ACK_POLL_LIMIT 20
+
+// CPU cycles (150MHz) per i2cee_delay(), a quarter of an I2C bit.
+// 100 -> Fast-mode, about 330kHz.  960 gives back the original ~40kHz pace.
+#define I2CEE_DELAY_CYCLES 100
+// Most times one i2cee_delay() polls CpuTimer0 before it gives up waiting,
+// in case Timer0 is stopped.  A poll takes about 10 cycles, so this is some
+// 10 x I2CEE_DELAY_CYCLES: never reached with Timer0 running, and with it
+// stopped the bus drops back to about the original 40kHz pace.
+#define I2CEE_DELAY_POLL_LIMIT 100
+
 extern Uint16 i2ceeSelectedEeprom;
 extern Uint16 eeProm1ByteRWAddr;
 extern Uint16 eeProm32ByteRWAddr;
 
 bool i2cee_write(Uint16* dataBuf, Uint16 countBytesToWrite, Uint16 eepromAddr);
 bool i2cee_write1Byte(Uint16 data, bool send_start, bool send_stop);
+bool i2cee_ackPoll(void);
 Uint16 i2cee_read1Byte(bool send_stop);
 void i2cee_Init(void);
 void i2cee_writeProtect(bool on_not_off );
@@ -31,7 +31,8 @@ enum LED_ERROR_NUMBER {
 	LED_ERROR_FPGA_CRC               =  5, // Fail loading FPGA from Flash: CRC failure
 	LED_ERROR_DONE_LINE_LOW          =  6, // Fail loading FPGA from Flash: DONE Line did not go HI
 	LED_ERROR_7                      =  7, // Used temporarily for testing 2/11/2015
-	LED_ERROR_NO_POWER_GOOD_IO       =  8  // main() did not see Power_Good, skipped loading TB3IOMC FPGAs
+	LED_ERROR_NO_POWER_GOOD_IO       =  8, // main() did not see Power_Good, skipped loading TB3IOMC FPGAs
+	LED_ERROR_BITSTREAM_CHECKSUM     =  9  // Fail loading FPGA from Flash: bitstream does not match header checksum
 };
 
 //-o-o-o-o-o-o-o-o-o-o-o-o-o-o-o-o-o-o-o-o-o-o-o-o-o-o-o-o-o-o-o-o-o-o-o-o-o-
@@ -114,6 +114,7 @@ void main(void) {
    evtimer4_store_int_vectors_in_PIE();
    f2i_store_int_vectors_in_PIE(); // XInt13 from FPGA #2 for SS Enc
    f1i_store_int_vectors_in_PIE(); // XInt1 from FPGA #1
+   canC_store_int_vectors_in_PIE(); // eCAN receive mailboxes
 
 // Step 4. Initialize all the Device Peripherals:
 // This function is found in DSP281x_InitPeripherals.c
@@ -171,6 +172,7 @@ void main(void) {
    timer0_init_03();
    evtimer4_enable_int();
    f2i_enable_interrupt();  // Int13 from FPGA #2 for SS Enc
+   canC_enable_interrupt(); // eCAN receive, frames handled in TASKNUM_canC_BgTask_recv
 // Enable global Interrupts and higher priority real-time debug events:
    EINT;   // Enable Global interrupt INTM
 // CPU_enableGlobalInts(myCpu);
@@ -185,8 +187,6 @@ void main(void) {
 
 	   taskMgr_runBkgndTasks();
 
-	   canC_pollRecv(); // see if we have received anything on CAN
-
 	   if (co_reset != 0) {
 	   // Upon receiving CAN 0x2036.3, we set do_reset to a non-zero
 	   //   value then we decrement it each time through the main loop and
@@ -98,3 +98,117 @@ Uint16  mcsParseReceivedData(char *mcsDataIn,Uint16 countCharIn,
    // Ran into something in the data that we weren't anticipating
    return MCS_PARSE_BAD_REC;
 }
+
+
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+//   Streaming MCS parser
+//
+//   mcsParseStream() consumes characters from mcsDataIn until it completes
+//   a record or runs out of characters.  *countCharUsed tells the caller
+//   how far we got, so it can act on the record and call again with the
+//   rest of the chunk.  Returns:
+//     MCS_PARSE_NO_ERR -- all characters used, record (if any) incomplete
+//     MCS_PARSE_RECEIVED_SOME_DATA, _ADDR_EXTEN, _EOF -- record complete,
+//        checksum good, fields & data bytes are in *parser
+//     any other MCS_PARSE_ERR -- bad data, caller should stop
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void mcsParseStreamInit(struct MCS_STREAM_PARSER *parser){
+	parser->inRecord = false;
+	parser->nibbleCount = 0;
+	parser->numDataBytes = 0;
+}
+
+Uint16 mcsParseStream(struct MCS_STREAM_PARSER *parser,
+		              char *mcsDataIn, Uint16 countCharIn, Uint16 *countCharUsed)
+{
+	Uint16 i;
+	Uint16 c;
+	Uint16 nibble;
+	Uint16 byteIndex;
+
+	for (i=0;i<countCharIn;i++) {
+		c = *(mcsDataIn++) & 0x00FF;
+
+		if (parser->inRecord == false) {
+			// between records: skip line endings, look for the ':'
+			if ((c == '\r') || (c == '\n')) {
+				continue;
+			}
+			if (c != ':') {
+				*countCharUsed = i + 1;
+				return MCS_PARSE_BOGUS_FIRST_CHAR;
+			}
+			parser->inRecord = true;
+			parser->nibbleCount = 0;
+			parser->checkSum = 0;
+			parser->byteCount = 0;
+			parser->numDataBytes = 0;
+			continue;
+		}
+
+		if ((c >= '0') && (c <= '9')) {
+			nibble = c - '0';
+		} else if ((c >= 'A') && (c <= 'F')) {
+			nibble = c - ('A' - 10);
+		} else if ((c >= 'a') && (c <= 'f')) {
+			nibble = c - ('a' - 10);
+		} else {
+			*countCharUsed = i + 1;
+			parser->inRecord = false;
+			if ((c == '\r') || (c == '\n')) {
+				return MCS_PARSE_BAD_CHAR_COUNT;  // record ended early
+			}
+			return MCS_PARSE_NON_HEX_CHAR;
+		}
+
+		parser->byteValue = (parser->byteValue << 4) | nibble;
+		parser->nibbleCount++;
+		if ((parser->nibbleCount & 1) != 0) {
+			continue;  // only have the high nibble so far
+		}
+
+		// a full byte: add it into the check sum and file it away.
+		// Record layout is count(1) addr(2) type(1) data(count) checksum(1)
+		parser->byteValue &= 0x00FF;
+		parser->checkSum += parser->byteValue;
+		byteIndex = (parser->nibbleCount >> 1) - 1;
+
+		if (byteIndex == 0) {
+			parser->byteCount = parser->byteValue;
+			if (parser->byteCount > MCS_STREAM_MAX_DATA_BYTES) {
+				*countCharUsed = i + 1;
+				parser->inRecord = false;
+				return MCS_PARSE_BAD_CHAR_COUNT;
+			}
+		} else if (byteIndex == 1) {
+			parser->addr = parser->byteValue << 8;
+		} else if (byteIndex == 2) {
+			parser->addr |= parser->byteValue;
+		} else if (byteIndex == 3) {
+			parser->recType = parser->byteValue;
+		} else if (byteIndex < (4 + parser->byteCount)) {
+			parser->dataBytes[parser->numDataBytes++] = parser->byteValue;
+		} else {
+			// that was the check sum byte, so the record is complete
+			*countCharUsed = i + 1;
+			parser->inRecord = false;
+			if ((parser->checkSum & 0xFF) != 0) {
+				return MCS_PARSE_BAD_CHECK_SUM;
+			}
+			if ((parser->recType == 0) && (parser->byteCount > 0)){
+				return MCS_PARSE_RECEIVED_SOME_DATA;
+			} else if ((parser->recType == 4) && (parser->byteCount == 2)){
+				return MCS_PARSE_RECEIVED_ADDR_EXTEN;
+			} else if ((parser->recType == 1) && (parser->byteCount == 0)){
+				return MCS_PARSE_RECEIVED_EOF;
+			} else  if ((parser->recType != 0)&& (parser->recType != 1)&& (parser->recType != 4)){
+				return MCS_PARSE_BAD_REC_TYPE;
+			}
+			return MCS_PARSE_BAD_REC;
+		}
+	}
+
+	// used up all the characters without completing a record
+	*countCharUsed = countCharIn;
+	return MCS_PARSE_NO_ERR;
+}
@@ -24,6 +24,10 @@
 #include "SSEnc.H"
 #include "DigIO.H"
 #include "FpgaTest.H"
+#include "CanOpen.h"
+#include "CanComm.h"
+#include "StrUtil.H"
+#include "HexUtil.H"
 
 //- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 // TASK MANAGER FEATURES
@@ -42,11 +46,26 @@
 //   Some time later, when the main loop calls taskMgr_runBkgndTasks(), it sees the
 //   bit set in taskFlags[] and calls the appropriate task.
 //
-//   DELAY: calls to taskMgr_setTaskWithDelay() store a time delay value -- 0.1 sec
-//   units -- into the task's entry in the taskDelays[] array.  Non-zero delay values
-//   are aged (decremented) by a background task kicked off from the Timer0 interrupt.
-//   the function taskMgr_runBkgndTasks() won't kick off a task unless it's
-//   taskDelays[] entry is 0.
+//   DELAY: calls to taskMgr_setTaskWithDelay() (0.1 sec units) or
+//   taskMgr_setTaskWithDelayMs() (1 milisec units) put the task into a hashed
+//   timer wheel -- TASK_WHEEL_SLOTS lists, one per milisec, with a count of
+//   whole trips around the wheel remaining for delays longer than the wheel.
+//   Inserting or removing a task is a constant-time list operation.  Each milisec
+//   timer0_miliSecTask() calls taskMgr_tickDelayWheel(), which looks only at the
+//   one slot whose time has come, so idle delays cost nothing.
+//   The function taskMgr_runBkgndTasks() won't kick off a task while it is in
+//   the wheel.
+//
+//   READY BITMAP: taskFlags[] holds every task that has been requested, delayed
+//   or not.  taskReadyFlags[] holds only those not waiting in the timer wheel, and
+//   taskReadySummary has bit i set whenever taskReadyFlags[i] is non-zero.
+//   taskMgr_firstSetTaskFlag() picks a word from taskReadySummary and a bit
+//   within that word using a nibble lookup, so finding the next task to run takes
+//   the same few steps whether it is task #0 or task #0x2F.  Interrupts call
+//   taskMgr_setTask() too (canC_recvIsr, the SCI receive ISR), so every
+//   read-modify-write of taskFlags[], taskReadyFlags[] or taskReadySummary from
+//   the background runs with interrupts disabled -- otherwise an interrupt
+//   landing between our read and our write would have its request wiped out.
 //
 //   SCHEDULING:  Priority scheduling (the default) means that the taskMgr_runBkgndTasks()
 //   function always runs the highest priority task scheduled.  Each time it is called,
@@ -56,6 +75,11 @@
 //   continues to reschedule itself every time it runs, than lower priority tasks will never
 //   run.  As an alternative, we provide a taskMgr_setTaskRoundRobin() call to request
 //   that a task not be allowed to block lower priority tasks.
+//
+//   PROFILE: with TASKMGR_ENABLE_PROFILE defined in TaskMgr.h, taskMgr_runBkgndTasks()
+//   reads timer0_freeRunStamp() before and after each task and accumulates call count,
+//   total and worst-case CPU cycles per task in taskProfile[].  Read them over
+//   CAN at index 0x2059, or on RS232 with the C1021:dddd command.
 //- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 // TASK MANAGER -- HOW TO USE IT
 //
@@ -74,6 +98,8 @@
 //          void taskMgr_setTask(Uint16 task_number)
 //          void taskMgr_setTaskWithDelay(Uint16 task_number, Uint16 delayInSecTenths)
 //          void taskMgr_setTaskRoundRobin(Uint16 task_number, Uint16 delayInSecTenths)
+//          void taskMgr_setTaskWithDelayMs(Uint16 task_number, Uint32 delayInMiliSec)
+//          void taskMgr_setTaskRoundRobinMs(Uint16 task_number, Uint32 delayInMiliSec)
 //   (5) Priority and Scheduling -- Tasks That Re-Schedule Themselves
 //       Say, for example you have a task that checks to see if something has
 //       completed, and if not, then the task reschedules itself to check again
@@ -89,6 +115,11 @@
 //- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 void taskMgr_nulTask(void);
 Uint16 taskMgr_firstSetTaskFlag();
+Uint16 taskMgr_lowestSetBit(Uint16 bits);
+void taskMgr_setReady(Uint16 task_number);
+void taskMgr_clearReady(Uint16 task_number);
+void taskMgr_wheelInsert(Uint16 task_number, Uint32 delayInMiliSec);
+void taskMgr_wheelRemove(Uint16 task_number);
 
 // order of task entry points in this table is coordinated with the
 // order of task ordinal numbers in enum TaskNumber in TaskMgr.h,
@@ -99,10 +130,10 @@ const TASK task_vectors[] = {
 		taskMgr_nulTask,		// 0x00
 		rs232_BgTask_TxDone,	// 0x01
 		f2i_BgTask_SSEnc,		// 0x02
-		taskMgr_nulTask,		// 0x03
+		canC_BgTask_recv,		// 0x03
 		timer0_task,			// 0x04
 		f1i_BgTask,				// 0x05
-		taskMgr_nulTask,		// 0x06
+		canO_blockUploadTask,	// 0x06
 		taskMgr_nulTask,		// 0x07
 		taskMgr_nulTask,		// 0x08
 		taskMgr_nulTask,		// 0x09
@@ -150,41 +181,146 @@ const TASK task_vectors[] = {
 
 Uint16 taskFlags[((MAX_NUMBER_OF_TASKS + 15)/16)]; // rounds up (MAX_NUMBER_OF_TASKS/16)
 Uint16 taskRoundRobinFlags[((MAX_NUMBER_OF_TASKS + 15)/16)]; // rounds up (MAX_NUMBER_OF_TASKS/16)
+Uint16 taskReadyFlags[((MAX_NUMBER_OF_TASKS + 15)/16)]; // taskFlags[] not waiting in the timer wheel
+Uint16 taskReadySummary;	// bit i set if taskReadyFlags[i] != 0 (MAX_TASKFLAG_WORDS <= 16)
 Uint16 prevTaskNumber;
 enum TASK_SCHED_SCHEME schedulingScheme;
 Uint16 JustForDebug;
 
-Uint16 taskDelays[MAX_NUMBER_OF_TASKS];
+// Hashed timer wheel for delayed tasks, 1 milisec per slot.
+// taskWheelSlot[task] is the slot a delayed task is waiting in, or
+// TASK_NOT_IN_WHEEL.  Slots are doubly linked lists threaded through
+// taskWheelNext[] / taskWheelPrev[], so each task can be unlinked directly.
+#define TASK_WHEEL_SLOTS 64			// power of 2
+#define TASK_WHEEL_SLOT_MASK (TASK_WHEEL_SLOTS - 1)
+#define TASK_WHEEL_SLOT_SHIFT 6		// log2(TASK_WHEEL_SLOTS)
+#define TASK_NOT_IN_WHEEL 0xFFFF
+
+Uint16 taskWheelHead[TASK_WHEEL_SLOTS];
+Uint16 taskWheelNext[MAX_NUMBER_OF_TASKS];
+Uint16 taskWheelPrev[MAX_NUMBER_OF_TASKS];
+Uint16 taskWheelSlot[MAX_NUMBER_OF_TASKS];
+Uint32 taskWheelRounds[MAX_NUMBER_OF_TASKS]; // trips around the wheel still to wait
+Uint16 taskWheelNow;	// slot processed on the most recent milisec tick
+
+#ifdef TASKMGR_ENABLE_PROFILE
+// Per-task execution time, in CPU cycles (150MHz)
+struct TASK_PROFILE {
+	Uint32 callCount;
+	unsigned long long totalCycles; // 64 bits, 32 would wrap after 28 sec of run time
+	Uint32 worstCycles;
+};
+struct TASK_PROFILE taskProfile[MAX_NUMBER_OF_TASKS];
+Uint16 taskMgr_profileTaskNumber; // task selected for reading via CAN 0x2059
+void taskMgr_profileRecord(Uint16 task_number, Uint32 cycles);
+#endif
+
+// Bit number (0-3) of the lowest set bit in a non-zero nibble
+const Uint16 lowestSetBitInNibble[16] = {
+		0, 0, 1, 0, 2, 0, 1, 0, 3, 0, 1, 0, 2, 0, 1, 0
+};
 
 void taskMgr_init(void){
 	int i;
 	for (i = 0; i < MAX_TASKFLAG_WORDS; i++){
 		taskFlags[i] = 0;
+		taskReadyFlags[i] = 0;
+	}
+	taskReadySummary = 0;
+	for (i = 0; i < TASK_WHEEL_SLOTS; i++){
+		taskWheelHead[i] = TASK_NOT_IN_WHEEL;
 	}
 	for (i = 0; i < MAX_NUMBER_OF_TASKS; i++){
-		taskDelays[i] = 0;
+		taskWheelSlot[i] = TASK_NOT_IN_WHEEL;
 	}
+	taskWheelNow = 0;
+#ifdef TASKMGR_ENABLE_PROFILE
+	taskMgr_profileReset();
+#endif
 
 	prevTaskNumber = MAX_NUMBER_OF_TASKS;
 	schedulingScheme = TASK_SCHED_PRIORITY;
 }
 
+// Return bit number (0-15) of the lowest set bit in a non-zero word.
+// Fixed number of steps, regardless of which bit is set.
+Uint16 taskMgr_lowestSetBit(Uint16 bits){
+	Uint16 bitNumber = 0;
+
+	if ((bits & 0x00FF) == 0){
+		bits >>= 8;
+		bitNumber = 8;
+	}
+	if ((bits & 0x000F) == 0){
+		bits >>= 4;
+		bitNumber += 4;
+	}
+	return bitNumber + lowestSetBitInNibble[bits & 0x000F];
+}
+
+// Mark a task as ready to run -- set its bit in taskReadyFlags[], then
+// set the summary bit for that word.
+// Caller has interrupts disabled.
+void taskMgr_setReady(Uint16 task_number){
+	Uint16 wordOffset;
+
+	wordOffset = task_number >> 4;
+	taskReadyFlags[wordOffset] |= (0x0001 << (task_number & 0x000F));
+	taskReadySummary |= (0x0001 << wordOffset);
+}
+
+// Remove a task from the ready bitmap, and clear the summary bit if its
+// word goes to 0.
+// Caller has interrupts disabled.
+void taskMgr_clearReady(Uint16 task_number){
+	Uint16 wordOffset;
+
+	wordOffset = task_number >> 4;
+	taskReadyFlags[wordOffset] &= ~(0x0001 << (task_number & 0x000F));
+	if (taskReadyFlags[wordOffset] == 0){
+		taskReadySummary &= ~(0x0001 << wordOffset);
+	}
+}
+
 // Set a bit in the task table, to schedule future running of a task.
+// May be called from interrupts as well as from background tasks.
 // NOTE: not yet protected from bad input
 void taskMgr_setTask(Uint16 task_number){
 	Uint16 taskFlag_wordOffset;
 	Uint16 taskFlag_bit;
+	Uint16 intState;
 
 	taskFlag_wordOffset = task_number >> 4;
 	taskFlag_bit = 0x0001 << (task_number & 0x000F);
+	intState = __disable_interrupts();
 	taskFlags[taskFlag_wordOffset] |= taskFlag_bit;
+	if (taskWheelSlot[task_number] == TASK_NOT_IN_WHEEL){
+		taskMgr_setReady(task_number);
+	}
+	__restore_interrupts(intState);
 }
 
 // Schedule running a task after a prescribed time delay.
+// May be called from interrupts as well as from background tasks.
 void taskMgr_setTaskWithDelay(Uint16 task_number, Uint16 delayInSecTenths){
 
+	taskMgr_setTaskWithDelayMs(task_number, (Uint32)delayInSecTenths * 100L);
+}
+
+// Schedule running a task after a prescribed time delay in milisec.
+// A delay of 0 makes the task ready now, cancelling any delay in progress.
+// May be called from interrupts as well as from background tasks.
+void taskMgr_setTaskWithDelayMs(Uint16 task_number, Uint32 delayInMiliSec){
+	Uint16 intState;
+
+	intState = __disable_interrupts();
+	taskMgr_wheelRemove(task_number);
+	if (delayInMiliSec != 0){
+		taskMgr_clearReady(task_number); // blocked until the wheel expires it
+		taskMgr_wheelInsert(task_number, delayInMiliSec);
+	}
 	taskMgr_setTask(task_number);
-	taskDelays[task_number] = delayInSecTenths;
+	__restore_interrupts(intState);
 }
 
 // Schedule running a task after a prescribed time delay (possibly 0).
@@ -192,13 +328,21 @@ void taskMgr_setTaskWithDelay(Uint16 task_number, Uint16 delayInSecTenths){
 // we run any requested lower priority tasks (higher task #), before returning to
 // priority scheduling.
 void taskMgr_setTaskRoundRobin(Uint16 task_number, Uint16 delayInSecTenths){
+
+	taskMgr_setTaskRoundRobinMs(task_number, (Uint32)delayInSecTenths * 100L);
+}
+
+void taskMgr_setTaskRoundRobinMs(Uint16 task_number, Uint32 delayInMiliSec){
 	Uint16 taskRRFlag_wordOffset;
 	Uint16 taskRRFlag_bit;
+	Uint16 intState;
 
-	taskMgr_setTaskWithDelay(task_number, delayInSecTenths);
 	taskRRFlag_wordOffset = task_number >> 4;
 	taskRRFlag_bit = 0x0001 << (task_number & 0x000F);
+	intState = __disable_interrupts();
 	taskRoundRobinFlags[taskRRFlag_wordOffset] |= taskRRFlag_bit;
+	taskMgr_setTaskWithDelayMs(task_number, delayInMiliSec);
+	__restore_interrupts(intState);
 }
 
 void taskMgr_nulTask(void){
@@ -209,6 +353,9 @@ void taskMgr_nulTask(void){
 // Run the task corresponding to the first non-zero flag you find.
 void taskMgr_runBkgndTasks (void){
 	Uint16 taskNumber;
+#ifdef TASKMGR_ENABLE_PROFILE
+	Uint32 startStamp;
+#endif
 
 	taskNumber = taskMgr_firstSetTaskFlag();
 	prevTaskNumber = taskNumber; // save this for next time thru here
@@ -222,72 +369,271 @@ void taskMgr_runBkgndTasks (void){
 	} else {
 		// Run the task, given an integer index into an array of function pointers
 		// Either of the following 2 forms succeeds to call through a table of pointers
+#ifdef TASKMGR_ENABLE_PROFILE
+		startStamp = TASKMGR_CYCLE_STAMP();
+#endif
 		(*task_vectors[taskNumber])();
 		// task_vectors[taskNumber](); This form also does the same thing
+#ifdef TASKMGR_ENABLE_PROFILE
+		taskMgr_profileRecord(taskNumber, TASKMGR_CYCLE_STAMP() - startStamp);
+#endif
 	}
 }
 
-// Search taskFlags[] for first flag that is Set,(non-0), meaning "run the task"
-//   AND where taskDelays[i] == 0, meaning "no wait-time remaining before running the task."
+// Find the first task that is Set in taskFlags[], (non-0), meaning "run the task"
+//   AND that is not in the timer wheel, meaning "no wait-time remaining before running the task."
+//   Those are exactly the bits in taskReadyFlags[].
+// Under priority scheduling that is the lowest numbered ready task.  If the previous
+//   task requested round robin scheduling, then we only consider higher numbered tasks.
 // Reset the flag, and
 // Return corresponding task number for first set flag
 // Or return MAX_NUMBER_OF_TASKS if no flag is set
 Uint16 taskMgr_firstSetTaskFlag(){
-	Uint16 i,j;
-	Uint16 taskNumber=0;
+	Uint16 firstCandidate;
+	Uint16 wordOffset;
 	Uint16 flags;
-	Uint16 shiftedBit;
+	Uint16 summary;
+	Uint16 taskNumber;
+	Uint16 taskFlag_bit;
+	Uint16 intState;
 
-	for (i = 0; i < MAX_TASKFLAG_WORDS; i++){
-		flags = taskFlags[i];
-		if (flags == 0) {        // if all 16 bits are 0, don't bother shifting through them
-			taskNumber += 16;    // just advance to the next task word
-	        if (taskNumber >= MAX_NUMBER_OF_TASKS){
-				return taskNumber;
-	        }
-			continue;     // skip to next iteration of for loop
+	if ((schedulingScheme == TASK_SCHED_PRIORITY) || (prevTaskNumber >= MAX_NUMBER_OF_TASKS)){
+		firstCandidate = 0;
+	} else {
+		firstCandidate = prevTaskNumber + 1;
+		if (firstCandidate >= MAX_NUMBER_OF_TASKS){
+			return MAX_NUMBER_OF_TASKS;
 		}
-		shiftedBit = 0x0001;
-		for (j = 0;j<16;j++){
-
-			if((flags & shiftedBit) && (taskDelays[taskNumber] == 0)) {
-				//*** FOUND a flag set
-				if ((schedulingScheme == TASK_SCHED_PRIORITY)
-            	|| ((taskNumber > prevTaskNumber) || (prevTaskNumber >= MAX_NUMBER_OF_TASKS))) {
-            	   //If we are doing priority scheduling, we look at first task we find.
-            	   //If previous task requested round robin scheduling, then we only consider
-            	   // higher numbered tasks.
-					taskFlags[i] ^= shiftedBit; //XOR to reset task flag bit
-					if (taskRoundRobinFlags[i] & shiftedBit){
-						schedulingScheme = TASK_SCHED_ROUNDROBIN;
-					}
-					return taskNumber;
-				}
-			}
-			taskNumber++;
-			shiftedBit <<= 1; // 1 bit left shift
+	}
+
+	// ready tasks at or above firstCandidate in its own word
+	wordOffset = firstCandidate >> 4;
+	flags = taskReadyFlags[wordOffset] & (0xFFFF << (firstCandidate & 0x000F));
+	if (flags == 0){
+		// otherwise the first non-empty word above it
+		summary = taskReadySummary & (0xFFFE << wordOffset);
+		if (summary == 0){
+			return MAX_NUMBER_OF_TASKS;
 		}
-        if (taskNumber >= MAX_NUMBER_OF_TASKS){
-			return taskNumber;
-        }
+		wordOffset = taskMgr_lowestSetBit(summary);
+		flags = taskReadyFlags[wordOffset];
+	}
+
+	taskNumber = (wordOffset << 4) + taskMgr_lowestSetBit(flags);
+	taskFlag_bit = 0x0001 << (taskNumber & 0x000F);
+	// An interrupt may be setting other bits in these same words
+	intState = __disable_interrupts();
+	taskFlags[wordOffset] &= ~taskFlag_bit; // reset task flag bit
+	taskMgr_clearReady(taskNumber);
+	__restore_interrupts(intState);
+	if (taskRoundRobinFlags[wordOffset] & taskFlag_bit){
+		schedulingScheme = TASK_SCHED_ROUNDROBIN;
 	}
 	return taskNumber;
 }
 
-void taskMgr_ageTaskDelays(void){
-	// Called each 0.1 sec from a background task kicked of by Timer0
-	// We decrement any non-zero entries in the taskDelays[] table.
-	// Non zero entries in the taskDelays[] table block the task from running
-	// until after we decrement them to zero.
+// Put a task into the timer wheel, to expire delayInMiliSec (non-0) ticks from now.
+// Caller has interrupts disabled and has already removed the task from the wheel.
+void taskMgr_wheelInsert(Uint16 task_number, Uint32 delayInMiliSec){
+	Uint16 slot;
+	Uint16 head;
+
+	slot = (taskWheelNow + (Uint16)(delayInMiliSec & TASK_WHEEL_SLOT_MASK)) & TASK_WHEEL_SLOT_MASK;
+	taskWheelRounds[task_number] = (delayInMiliSec - 1) >> TASK_WHEEL_SLOT_SHIFT;
+	taskWheelSlot[task_number] = slot;
+
+	head = taskWheelHead[slot];
+	taskWheelNext[task_number] = head;
+	taskWheelPrev[task_number] = TASK_NOT_IN_WHEEL;
+	if (head != TASK_NOT_IN_WHEEL){
+		taskWheelPrev[head] = task_number;
+	}
+	taskWheelHead[slot] = task_number;
+}
+
+// Take a task out of the timer wheel, if it is in it.
+// Caller has interrupts disabled.
+void taskMgr_wheelRemove(Uint16 task_number){
+	Uint16 slot;
+	Uint16 next;
+	Uint16 prev;
+
+	slot = taskWheelSlot[task_number];
+	if (slot == TASK_NOT_IN_WHEEL){
+		return;
+	}
+	next = taskWheelNext[task_number];
+	prev = taskWheelPrev[task_number];
+	if (prev == TASK_NOT_IN_WHEEL){
+		taskWheelHead[slot] = next;
+	} else {
+		taskWheelNext[prev] = next;
+	}
+	if (next != TASK_NOT_IN_WHEEL){
+		taskWheelPrev[next] = prev;
+	}
+	taskWheelSlot[task_number] = TASK_NOT_IN_WHEEL;
+}
+
+void taskMgr_tickDelayWheel(void){
+	// Called each milisec from timer0_miliSecTask.
+	// Advance the wheel one slot and look at the tasks waiting there.  Those
+	// with no trips around the wheel remaining are taken out of the wheel, and
+	// if they have been requested they move into the ready bitmap.  The others
+	// count down one trip.
 	// We don't start any tasks here, that's done elsewhere.
+	Uint16 intState;
+	Uint16 task_number;
+	Uint16 next;
+
+	intState = __disable_interrupts();
+	taskWheelNow = (taskWheelNow + 1) & TASK_WHEEL_SLOT_MASK;
+	task_number = taskWheelHead[taskWheelNow];
+	while (task_number != TASK_NOT_IN_WHEEL){
+		next = taskWheelNext[task_number];
+		if (taskWheelRounds[task_number] == 0){
+			taskMgr_wheelRemove(task_number);
+			if (taskFlags[task_number >> 4] & (0x0001 << (task_number & 0x000F))){
+				taskMgr_setReady(task_number);
+			}
+		} else {
+			taskWheelRounds[task_number]--;
+		}
+		task_number = next;
+	}
+	__restore_interrupts(intState);
+}
 
+#ifdef TASKMGR_ENABLE_PROFILE
+// ==========================================================================
+//    P R O F I L E R
+// ==========================================================================
+
+void taskMgr_profileReset(void){
 	int i;
 	for (i = 0; i < MAX_NUMBER_OF_TASKS; i++){
-		if (taskDelays[i] != 0){
-			taskDelays[i]--;
+		taskProfile[i].callCount = 0;
+		taskProfile[i].totalCycles = 0;
+		taskProfile[i].worstCycles = 0;
+	}
+}
+
+// Called from taskMgr_runBkgndTasks() after each task returns
+void taskMgr_profileRecord(Uint16 task_number, Uint32 cycles){
+	struct TASK_PROFILE* prof = &taskProfile[task_number];
+
+	prof->callCount++;
+	prof->totalCycles += cycles;
+	if (cycles > prof->worstCycles){
+		prof->worstCycles = cycles;
+	}
+}
+
+Uint32 taskMgr_profileAvgCycles(Uint16 task_number){
+	// division done here, when someone asks, not on every dispatch
+	if (taskProfile[task_number].callCount == 0){
+		return 0;
+	}
+	return (Uint32)(taskProfile[task_number].totalCycles / taskProfile[task_number].callCount);
+}
+
+// Report one task's profile to RS232 -- C1021:dddd command, dddd = task number
+void taskMgr_displayProfile(Uint16 task_number){
+	char msgOut[80];
+	char *ptr;
+
+	if (task_number >= MAX_NUMBER_OF_TASKS){
+		return;
+	}
+	ptr = strU_strcpy(msgOut,"Task 0x");
+	ptr = hexUtil_binTo2HexAsciiChars(ptr,task_number);
+	ptr = strU_strcpy(ptr," calls ");
+	ptr = hexUtil_bin32ToDecAsciiCharsZeroSuppress(ptr,taskProfile[task_number].callCount);
+	ptr = strU_strcpy(ptr," avg ");
+	ptr = hexUtil_bin32ToDecAsciiCharsZeroSuppress(ptr,taskMgr_profileAvgCycles(task_number));
+	ptr = strU_strcpy(ptr," max ");
+	ptr = hexUtil_bin32ToDecAsciiCharsZeroSuppress(ptr,taskProfile[task_number].worstCycles);
+	ptr = strU_strcpy(ptr," cyc\n\r");
+	r232Out_outChars(msgOut, (Uint16)(ptr - msgOut));
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+//       C A N   O P E N   R E S P O N S E S  (index 0x2059)
+//   2059.01 selects a task by writing its number to taskMgr_profileTaskNumber,
+//   2059.02 - .04 then report on the selected task.
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+enum CANOPEN_STATUS taskMgr_sendProfileCallCount(const struct CAN_COMMAND* can_command, Uint16* data){
+	// *data is MboxA of transmit Message
+	// *can_command is Table entry (struct) of parameters for CANOpen Index.Subindex
+	union CANOPEN16_32 value;
+
+	if (taskMgr_profileTaskNumber >= MAX_NUMBER_OF_TASKS){
+		return CANOPEN_TASKMGR_001_ERR;
+	}
+	value.all = taskProfile[taskMgr_profileTaskNumber].callCount;
+	*(data+2) = value.words.lsw; //MboxC
+	*(data+3) = value.words.msw; //MboxD
+	return CANOPEN_NO_ERR;
+}
+
+enum CANOPEN_STATUS taskMgr_sendProfileAvgCycles(const struct CAN_COMMAND* can_command, Uint16* data){
+	// *data is MboxA of transmit Message
+	// *can_command is Table entry (struct) of parameters for CANOpen Index.Subindex
+	union CANOPEN16_32 value;
+
+	if (taskMgr_profileTaskNumber >= MAX_NUMBER_OF_TASKS){
+		return CANOPEN_TASKMGR_001_ERR;
+	}
+	value.all = taskMgr_profileAvgCycles(taskMgr_profileTaskNumber);
+	*(data+2) = value.words.lsw; //MboxC
+	*(data+3) = value.words.msw; //MboxD
+	return CANOPEN_NO_ERR;
+}
+
+enum CANOPEN_STATUS taskMgr_sendProfileWorstCycles(const struct CAN_COMMAND* can_command, Uint16* data){
+	// *data is MboxA of transmit Message
+	// *can_command is Table entry (struct) of parameters for CANOpen Index.Subindex
+	union CANOPEN16_32 value;
+
+	if (taskMgr_profileTaskNumber >= MAX_NUMBER_OF_TASKS){
+		return CANOPEN_TASKMGR_001_ERR;
+	}
+	value.all = taskProfile[taskMgr_profileTaskNumber].worstCycles;
+	*(data+2) = value.words.lsw; //MboxC
+	*(data+3) = value.words.msw; //MboxD
+	return CANOPEN_NO_ERR;
+}
+
+enum CANOPEN_STATUS taskMgr_sendProfileWorstTask(const struct CAN_COMMAND* can_command, Uint16* data){
+	// Returns the task number with the largest worst-case time, MboxC,
+	// and that task's worst-case time in units of 256 cycles, MboxD.
+	// *data is MboxA of transmit Message
+	// *can_command is Table entry (struct) of parameters for CANOpen Index.Subindex
+	Uint16 i;
+	Uint16 worstTask = 0;
+
+	for (i = 1; i < MAX_NUMBER_OF_TASKS; i++){
+		if (taskProfile[i].worstCycles > taskProfile[worstTask].worstCycles){
+			worstTask = i;
 		}
 	}
+	*(data+2) = worstTask; //MboxC
+	if (taskProfile[worstTask].worstCycles > 0x00FFFFFFL){
+		*(data+3) = 0xFFFF;  //MboxD, saturate
+	} else {
+		*(data+3) = (Uint16)(taskProfile[worstTask].worstCycles >> 8); //MboxD
+	}
+	return CANOPEN_NO_ERR;
+}
+
+enum CANOPEN_STATUS taskMgr_recvProfileReset(const struct CAN_COMMAND* can_command, Uint16* data){
+	// writing any value clears profile data for all tasks
+	// *data is MboxA of received Message
+	// *can_command is Table entry (struct) of parameters for CANOpen Index.Subindex
+	taskMgr_profileReset();
+	return CANOPEN_NO_ERR;
 }
+#endif
 
 // ==========================================================================
 //    T A S K S
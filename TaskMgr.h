@@ -11,10 +11,12 @@ void taskMgr_init(void);
 void taskMgr_setTask(Uint16);
 void taskMgr_setTaskWithDelay(Uint16 task_number, Uint16 delayInSecTenths);
 void taskMgr_setTaskRoundRobin(Uint16 task_number, Uint16 delayInSecTenths);
+void taskMgr_setTaskWithDelayMs(Uint16 task_number, Uint32 delayInMiliSec);
+void taskMgr_setTaskRoundRobinMs(Uint16 task_number, Uint32 delayInMiliSec);
 void taskMgr_runBkgndTasks(void);
 void taskMgr_nulTask(void);
 void taskMgr_wDogReset(void);
-void taskMgr_ageTaskDelays(void);
+void taskMgr_tickDelayWheel(void);
 
 void taskMgr_testTask_1(void);
 void taskMgr_testTask_2(void);
@@ -23,6 +25,29 @@ void taskMgr_testTask_4(void);
 void taskMgr_testTask_5(void);
 void taskMgr_testSchedAlgorithms(Uint16 dataWord);
 
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// Turn on/off per-task execution time profiling (comment it out to turn off)
+// When on, taskMgr_runBkgndTasks() timestamps each task it dispatches and
+// keeps call count, total and worst-case CPU cycles for every task.
+//#define TASKMGR_ENABLE_PROFILE
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+#ifdef TASKMGR_ENABLE_PROFILE
+#include "CanOpen.h"            // CAN_COMMAND, for the CAN 0x2059 handlers below
+// Source of cycle timestamps for the profiler.  A build off the target
+// can #define this ahead of TaskMgr.h to substitute a simulated counter.
+#ifndef TASKMGR_CYCLE_STAMP
+#define TASKMGR_CYCLE_STAMP() timer0_freeRunStamp()
+#endif
+void taskMgr_profileReset(void);
+void taskMgr_displayProfile(Uint16 task_number);
+enum CANOPEN_STATUS taskMgr_sendProfileCallCount(const struct CAN_COMMAND* can_command, Uint16* data);
+enum CANOPEN_STATUS taskMgr_sendProfileAvgCycles(const struct CAN_COMMAND* can_command, Uint16* data);
+enum CANOPEN_STATUS taskMgr_sendProfileWorstCycles(const struct CAN_COMMAND* can_command, Uint16* data);
+enum CANOPEN_STATUS taskMgr_sendProfileWorstTask(const struct CAN_COMMAND* can_command, Uint16* data);
+enum CANOPEN_STATUS taskMgr_recvProfileReset(const struct CAN_COMMAND* can_command, Uint16* data);
+extern Uint16 taskMgr_profileTaskNumber;
+#endif
+
 
 // Create a user type called TASK
 //  pointer to function: void(task_name)(void):
@@ -37,10 +62,10 @@ enum TaskNumber {
 	TASKNUM_taskMgr_nulTask_0,
 	TASKNUM_BgTask_TxDone,
 	TASKNUM_F2Int_SSEnc,
-	TASKNUM_taskMgr_nulTask_3,
+	TASKNUM_canC_BgTask_recv,
 	TASKNUM_timer0_task,
 	TASKNUM_F1Int,
-	TASKNUM_taskMgr_nulTask_6,
+	TASKNUM_canO_blockUploadTask,
 	TASKNUM_taskMgr_nulTask_7,
 	TASKNUM_taskMgr_nulTask_8,
 	TASKNUM_taskMgr_nulTask_9,
@@ -77,6 +77,14 @@ void timer0_initConfig_n_Start(void){
 //	ConfigCpuTimer(&CpuTimer0, 150, 100000); // 150MHz CPU Freq, 0.1 second Period (in uSeconds)
 	ConfigCpuTimer(&CpuTimer0, 150, TIMER_0_PERIOD_IN_USEC);    // 150MHz CPU Freq, Period (in uSeconds)
 	StartCpuTimer0(); // #define for a bit-set in DSP281x_CpuTimers.h
+
+	// CPU-Timer 1 free-runs at SYSCLKOUT with no interrupt, for cycle
+	// timestamps, see timer0_freeRunStamp().  PRD is already 0xFFFFFFFF.
+	CpuTimer1Regs.TPR.all  = 0;
+	CpuTimer1Regs.TPRH.all = 0;
+	CpuTimer1Regs.TCR.bit.TIE = 0;
+	CpuTimer1Regs.TCR.bit.TRB = 1;
+	CpuTimer1Regs.TCR.bit.TSS = 0;
 }
 
 void timer0_init_03(void){
@@ -198,8 +206,6 @@ void timer0_task(void){
 void timer0_tenthOfSecTask(void){
 // Runs every 0.1 sec
 
-	taskMgr_ageTaskDelays();
-
 	if (++timer0_count_Tenths < 5) {
 		return;
 	}
@@ -225,6 +231,9 @@ void timer0_miliSecTask(void){
 
 	timer0_SystemMiliSecCount++;
 
+	// expire any delayed tasks whose time has come
+	taskMgr_tickDelayWheel();
+
 	// every milisec we call the limit check state machine code
 	limChkStateMachine();
 }
@@ -281,3 +290,14 @@ Uint32 timer0_count_reg_value(){
 
 }
 
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+//  Free-running count of CPU cycles (150MHz), modulo 2^32, from CPU-Timer 1
+//  started in timer0_initConfig_n_Start().  The timer counts down, so we
+//  return the complement to get a count that goes up.  It is a single
+//  32-bit register read: it never stops a timer or masks an interrupt, so
+//  it is cheap and safe to call from ISRs.  Wraps about every 28.6 sec.
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+Uint32 timer0_freeRunStamp(void){
+	return ~CpuTimer1Regs.TIM.all;
+}
+
@@ -17,6 +17,7 @@ void timer0_task_init();
 void timer0_miliSecTask(void);
 Uint32 timer0_interrupt_count_value();
 Uint32 timer0_count_reg_value();
+Uint32 timer0_freeRunStamp(void);
 Uint32 timer0_fetchSystemMiliSecCount(void);
 
 